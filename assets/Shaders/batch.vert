@@ -0,0 +1,31 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aShape;
+out vec2 TexCoord;
+out vec4 Color;
+out vec2 WorldPos;
+#ifndef TEXTURED
+flat out vec4 Shape;
+#endif
+layout (std140) uniform Camera {
+   mat4 view;
+   mat4 projection;
+   // Light grid origin (xy), tiles per world unit (z), lit (w); see LightGrid
+   vec4 lightGrid;
+   vec4 lightGridSize;
+   vec4 ambient;
+   // Animation clock in seconds (x); see AnimationClips
+   vec4 clock;
+};
+void main()
+{
+   gl_Position = projection * view * vec4(aPos, 0.0, 1.0);
+   WorldPos = aPos;
+   TexCoord = aTexCoord;
+#ifndef TEXTURED
+   Shape = aShape;
+#endif
+   Color = aColor;
+}
@@ -0,0 +1,79 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoord;
+in vec4 Color;
+in vec2 WorldPos;
+layout (std140) uniform Camera {
+   mat4 view;
+   mat4 projection;
+   // Light grid origin (xy), tiles per world unit (z), lit (w); see LightGrid
+   vec4 lightGrid;
+   vec4 lightGridSize;
+   vec4 ambient;
+   // Animation clock in seconds (x); see AnimationClips
+   vec4 clock;
+};
+// Lights binned into screen tiles by LightGrid: two texels per light, and
+// per-tile start offsets followed by the light indices
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightIndices;
+vec3 Lighting(vec2 p)
+{
+   ivec2 tile = ivec2(floor((p - lightGrid.xy) * lightGrid.z));
+   ivec2 size = ivec2(lightGridSize.xy);
+   if (any(lessThan(tile, ivec2(0))) || any(greaterThanEqual(tile, size))) {
+      return ambient.rgb;
+   }
+   int t = tile.y * size.x + tile.x;
+   int first = int(texelFetch(lightIndices, t).r);
+   int last = int(texelFetch(lightIndices, t + 1).r);
+   vec3 light = ambient.rgb;
+   for (int i = first; i < last; i++) {
+      int index = int(texelFetch(lightIndices, i).r);
+      vec4 positionFalloff = texelFetch(lightData, 2 * index);
+      vec2 d = p - positionFalloff.xy;
+      // Smooth falloff, zero at the radius
+      float f = clamp(1.0 - dot(d, d) * positionFalloff.z, 0.0, 1.0);
+      light += texelFetch(lightData, 2 * index + 1).rgb * (f * f);
+   }
+   return light;
+}
+#ifdef TEXTURED
+uniform sampler2D tex;
+#else
+// Half size (xy), kind (z), parameter (w); TexCoord is the offset from the
+// quad center in the same units
+flat in vec4 Shape;
+float ShapeDistance(vec2 p)
+{
+   vec2 halfSize = Shape.xy;
+   float shortHalf = min(halfSize.x, halfSize.y);
+   int kind = int(Shape.z + 0.5);
+   if (kind <= 2) {
+      // Ellipse, approximated by scaling a circle of the short radius
+      float d = (length(p / max(halfSize, 1e-4)) - 1.0) * shortHalf;
+      // Ring: band of the given thickness inside the outline
+      return kind == 2 ? abs(d + Shape.w * 0.5) - Shape.w * 0.5 : d;
+   }
+   // Rounded rectangle; a capsule rounds by half the short side
+   float radius = kind == 4 ? shortHalf : clamp(Shape.w, 0.0, shortHalf);
+   vec2 q = abs(p) - halfSize + radius;
+   return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+#endif
+void main()
+{
+#ifdef TEXTURED
+   FragColor = texture(tex, TexCoord) * Color;
+#else
+   FragColor = Color;
+   if (Shape.z > 0.5) {
+      // Signed distance to the edge, antialiased over one screen pixel
+      float d = ShapeDistance(TexCoord);
+      FragColor.a *= clamp(0.5 - d / max(fwidth(d), 1e-4), 0.0, 1.0);
+   }
+#endif
+   if (lightGrid.w > 0.5) {
+      FragColor.rgb *= Lighting(WorldPos);
+   }
+}
@@ -0,0 +1,63 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aPositionSize;
+layout (location = 3) in vec4 aTextureOffsetScale;
+layout (location = 4) in vec4 aColor;
+out vec2 TexCoord;
+out vec4 Color;
+out vec2 WorldPos;
+#ifndef TEXTURED
+flat out vec4 Shape;
+#endif
+layout (std140) uniform Camera {
+   mat4 view;
+   mat4 projection;
+   // Light grid origin (xy), tiles per world unit (z), lit (w); see LightGrid
+   vec4 lightGrid;
+   vec4 lightGridSize;
+   vec4 ambient;
+   // Animation clock in seconds (x); see AnimationClips
+   vec4 clock;
+};
+#ifdef TEXTURED
+uniform samplerBuffer animationClips;
+// Frame rect of an animated sprite's clip at the current clock
+vec4 ClipFrame(int clip, float startTime)
+{
+   vec4 header = texelFetch(animationClips, clip);
+   int count = int(header.x);
+   int frame = int(max(clock.x - startTime, 0.0) / header.y);
+   int loop = int(header.z);
+   if (loop == 0) {
+      frame = frame % count;
+   } else if (loop == 1) {
+      frame = min(frame, count - 1);
+   } else {
+      // Ping-pong runs forward, then back without repeating the ends
+      int period = max(2 * count - 2, 1);
+      frame = frame % period;
+      frame = frame < count ? frame : period - frame;
+   }
+   return texelFetch(animationClips, clip + 1 + frame);
+}
+#endif
+void main()
+{
+   vec2 worldPos = aPos.xy * aPositionSize.zw + aPositionSize.xy;
+   gl_Position = projection * view * vec4(worldPos, aPos.z, 1.0);
+   WorldPos = worldPos;
+#ifdef TEXTURED
+   vec4 frameRect = aTextureOffsetScale;
+   // A zero-size rect marks an animated sprite: clip id (x), start time (y)
+   if (frameRect.z == 0.0 && frameRect.w == 0.0) {
+      frameRect = ClipFrame(int(frameRect.x), frameRect.y);
+   }
+   TexCoord = (aTexCoord * frameRect.zw) + frameRect.xy;
+#else
+   // Solid sprites carry shape kind and parameter instead of a texture rect
+   TexCoord = aPos.xy * aPositionSize.zw;
+   Shape = vec4(abs(aPositionSize.zw) * 0.5, aTextureOffsetScale.xy);
+#endif
+   Color = aColor;
+}
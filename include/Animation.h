@@ -7,15 +7,20 @@
 
 class Animation {
 public:
-  Animation(Texture* spriteSheet, const std::vector<glm::vec4>& frames, float frameDuration);
+  // Frames are rects within spriteSheet, a ResourceManager texture
+  Animation(TextureHandle spriteSheet, const std::vector<glm::vec4>& frames,
+            float frameDuration);
   ~Animation();
 
   void Update(float deltaTime);
   glm::vec4 GetCurrentFrameCoords() const;
+  int GetCurrentFrameIndex() const { return m_CurrentFrameIndex; }
+  // Seconds until Update next changes the frame, -1 if it never will
+  float GetTimeToNextFrame() const;
   void Reset();
 
 private:
-  Texture* m_SpriteSheet;
+  TextureHandle m_SpriteSheet;
   std::vector<glm::vec4> m_Frames; // (x, y, width, height) in normalized texture coordinates
   float m_FrameDuration;
   int m_CurrentFrameIndex;
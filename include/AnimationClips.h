@@ -0,0 +1,60 @@
+#ifndef ANIMATIONCLIPS_H
+#define ANIMATIONCLIPS_H
+
+#include "Texture.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Values are the loop modes the sprite shader reads
+enum class AnimationLoop {
+  Loop = 0,     // 0 1 2 0 1 2 ...
+  Once = 1,     // 0 1 2 2 2 ...
+  PingPong = 2  // 0 1 2 1 0 1 ...
+};
+
+// Sprite-sheet animations evaluated by the sprite vertex shader. A clip's
+// frames live in a buffer texture, and an animated sprite only carries the
+// clip id and its start time (see SpriteBatch::AnimationParams), so nothing
+// about it changes per frame on the CPU. The shader picks the frame from
+// the shared clock in the camera uniform block.
+//
+// Table layout, one RGBA32F texel each: a clip's header (frame count, frame
+// duration, loop mode, 0) followed by its frame rects, already mapped to the
+// texture's atlas page. A clip id is the texel index of its header.
+class AnimationClips {
+public:
+  static constexpr int kTextureUnit = 3;
+
+  AnimationClips();
+  ~AnimationClips();
+
+  bool Init();
+  void Cleanup();
+
+  // frames are (x, y, width, height) in the texture's normalized
+  // coordinates, as Animation takes them. Returns the clip id, -1 if empty
+  int AddClip(const Texture* texture, const std::vector<glm::vec4>& frames,
+              float frameDuration, AnimationLoop loop = AnimationLoop::Loop);
+
+  // The clock sprites' start times refer to
+  void Advance(float deltaTime) { m_Time += deltaTime; }
+  float GetTime() const { return m_Time; }
+  // Sprites playing clips change every frame the clock advances
+  bool HasClips() const { return !m_Table.empty(); }
+
+  // Current frame rect of a clip started at startTime, matching the shader;
+  // for paths that build vertices on the CPU
+  glm::vec4 Evaluate(int clip, float startTime) const;
+
+  // Uploads the table if clips were added since the last call
+  void Upload();
+
+private:
+  GLuint m_Buffer, m_Texture;
+  std::vector<glm::vec4> m_Table;
+  size_t m_UploadedTexels;
+  float m_Time;
+};
+
+#endif // ANIMATIONCLIPS_H
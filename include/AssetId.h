@@ -0,0 +1,38 @@
+#ifndef ASSETID_H
+#define ASSETID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 64-bit FNV-1a; the same hash keys AssetPack entries
+constexpr uint64_t HashAssetName(std::string_view name) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : name) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Names an asset by the hash of its name. String literals convert
+// implicitly and hash at compile time, so GetTexture("player") neither
+// allocates nor hashes at run time; build ids from run-time strings with
+// FromString.
+struct AssetId {
+  uint64_t hash;
+
+  constexpr AssetId() : hash(0) {}
+  template <size_t N>
+  consteval AssetId(const char (&name)[N]) : hash(HashAssetName(std::string_view(name, N - 1))) {}
+
+  static constexpr AssetId FromString(std::string_view name) {
+    AssetId id;
+    id.hash = HashAssetName(name);
+    return id;
+  }
+
+  constexpr bool operator==(const AssetId& other) const { return hash == other.hash; }
+};
+
+#endif // ASSETID_H
@@ -0,0 +1,89 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include "AssetId.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Cooked assets in one file, written offline by asset_cooker and memory
+// mapped at startup. Everything is stored in the form the runtime consumes,
+// so loading is a lookup plus an upload or a pointer hand-off:
+//
+//   Texture  RGBA8 rows, top row first, followed by the rest of the mip
+//            chain down to 1x1 (each level half the previous, rounded down,
+//            at least 1)
+//   Sound    PCM in the mixer's output format, played from the mapping
+//   Blob     the file's bytes unchanged (fonts, music, shaders)
+//
+// Entries are keyed by HashAssetPath of the path the game passes to its
+// loaders ("assets/Character/knight.png"), and the table of contents is
+// sorted by hash for binary search. Integers are little-endian.
+//
+// Each entry also records the size and write time of the file it was cooked
+// from. Where that file still exists and no longer matches (edited since the
+// last cook), loaders skip the entry and read the loose file instead.
+enum class AssetType : uint32_t {
+  Blob = 0,
+  Texture = 1,
+  Sound = 2
+};
+
+struct AssetPackHeader {
+  char magic[4];        // kAssetPackMagic
+  uint32_t version;     // kAssetPackVersion
+  uint32_t entryCount;
+  uint32_t reserved;
+  uint64_t tocOffset;   // entryCount AssetPackEntry records
+};
+
+struct AssetPackEntry {
+  uint64_t hash;
+  uint64_t offset;      // from the start of the file, 16-byte aligned
+  uint64_t size;
+  AssetType type;
+  // Texture: width, height, mip levels. Sound: frequency, SDL audio format,
+  // channels. Blob: unused
+  uint32_t info[3];
+  uint64_t sourceSize;  // bytes of the cooked source file
+  int64_t sourceTime;   // its std::filesystem::last_write_time, in clock ticks
+};
+
+constexpr char kAssetPackMagic[4] = {'L', 'P', 'A', 'K'};
+constexpr uint32_t kAssetPackVersion = 2;
+constexpr uint64_t kAssetPackAlignment = 16;
+// Largest texture width or height Open accepts
+constexpr uint32_t kMaxAssetTextureSize = 16384;
+
+// HashAssetName of the path; paths must match exactly, '/' separated
+inline uint64_t HashAssetPath(const std::string& path) { return HashAssetName(path); }
+
+// Read-only view of a pack file. Data pointers stay valid until Close.
+class AssetPack {
+public:
+  AssetPack();
+  ~AssetPack();
+
+  bool Open(const std::string& path);
+  void Close();
+  bool IsOpen() const { return m_Data != nullptr; }
+
+  // nullptr if the pack has no such asset
+  const AssetPackEntry* Find(const std::string& path) const;
+  const uint8_t* GetData(const AssetPackEntry& entry) const { return m_Data + entry.offset; }
+  // False if the loose file at path exists and differs from the one entry
+  // was cooked from; true when there is no loose file (shipped packs)
+  static bool MatchesSource(const AssetPackEntry& entry, const std::string& path);
+  uint32_t GetEntryCount() const { return m_EntryCount; }
+
+private:
+  const uint8_t* m_Data;
+  size_t m_Size;
+  const AssetPackEntry* m_Entries;
+  uint32_t m_EntryCount;
+  // Win32 file and mapping handles; unused elsewhere
+  void* m_File;
+  void* m_Mapping;
+};
+
+#endif // ASSETPACK_H
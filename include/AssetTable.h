@@ -0,0 +1,162 @@
+#ifndef ASSETTABLE_H
+#define ASSETTABLE_H
+
+#include "AssetId.h"
+#include <cstdint>
+#include <vector>
+
+// Refers to the T an AssetTable holds under one id. Replacing the value keeps
+// the handle, so it resolves to the new one; once the table is cleared the
+// handle goes stale and Get returns nullptr instead of a dangling pointer. A
+// default-constructed handle is never valid.
+template <typename T>
+struct AssetHandle {
+  uint32_t index = 0;
+  uint32_t generation = 0;  // live entries start at 1
+
+  bool IsNull() const { return generation == 0; }
+  bool operator==(const AssetHandle& other) const = default;
+};
+
+// AssetId -> T* map with O(1) lookups and no allocation on lookup. Entries
+// live in a dense array that never reorders, so handles are plain indices
+// checked against a per-entry generation; an open-addressing index with
+// linear probing, kept at most half full, maps ids to entries. The table
+// does not own the values.
+template <typename T>
+class AssetTable {
+public:
+  AssetTable() : m_Count(0) {}
+
+  // Adds or replaces the value for id. A replaced value is returned through
+  // replaced (for the caller to free); handles to id now resolve to value.
+  AssetHandle<T> Insert(AssetId id, T* value, T** replaced = nullptr) {
+    if (replaced) {
+      *replaced = nullptr;
+    }
+    AssetHandle<T> existing = Find(id);
+    if (!existing.IsNull()) {
+      Entry& entry = m_Entries[existing.index];
+      if (replaced) {
+        *replaced = entry.value;
+      }
+      entry.value = value;
+      return existing;
+    }
+
+    if ((m_Count + 1) * 2 > m_Slots.size()) {
+      Rehash(m_Slots.empty() ? kMinSlots : m_Slots.size() * 2);
+    }
+    uint32_t index;
+    if (!m_Free.empty()) {
+      index = m_Free.back();
+      m_Free.pop_back();
+    } else {
+      index = (uint32_t)m_Entries.size();
+      m_Entries.push_back({0, nullptr, 1, false});
+    }
+    Entry& entry = m_Entries[index];
+    entry.hash = id.hash;
+    entry.value = value;
+    entry.live = true;
+    Place(index);
+    m_Count++;
+    return {index, entry.generation};
+  }
+
+  // Null handle if id is not in the table
+  AssetHandle<T> Find(AssetId id) const {
+    if (m_Count == 0) {
+      return {};
+    }
+    size_t mask = m_Slots.size() - 1;
+    for (size_t slot = Mix(id.hash) & mask; m_Slots[slot] != 0; slot = (slot + 1) & mask) {
+      uint32_t index = m_Slots[slot] - 1;
+      if (m_Entries[index].hash == id.hash) {
+        return {index, m_Entries[index].generation};
+      }
+    }
+    return {};
+  }
+
+  T* Get(AssetHandle<T> handle) const {
+    if (handle.index >= m_Entries.size() || handle.IsNull()) {
+      return nullptr;
+    }
+    const Entry& entry = m_Entries[handle.index];
+    return entry.generation == handle.generation ? entry.value : nullptr;
+  }
+  T* Get(AssetId id) const { return Get(Find(id)); }
+  bool IsValid(AssetHandle<T> handle) const { return Get(handle) != nullptr; }
+
+  // Calls visit(T*) for every value, e.g. to free them before Clear
+  template <typename Visitor>
+  void ForEach(Visitor&& visit) const {
+    for (const Entry& entry : m_Entries) {
+      if (entry.live && entry.value) {
+        visit(entry.value);
+      }
+    }
+  }
+
+  // Empties the table; every outstanding handle goes stale
+  void Clear() {
+    m_Free.clear();
+    for (uint32_t index = (uint32_t)m_Entries.size(); index-- > 0;) {
+      Entry& entry = m_Entries[index];
+      entry.hash = 0;
+      entry.value = nullptr;
+      entry.live = false;
+      NextGeneration(entry);
+      m_Free.push_back(index);
+    }
+    m_Slots.assign(m_Slots.size(), 0);
+    m_Count = 0;
+  }
+
+  size_t GetCount() const { return m_Count; }
+
+private:
+  static constexpr size_t kMinSlots = 16;
+
+  struct Entry {
+    uint64_t hash;
+    T* value;
+    uint32_t generation;
+    bool live;
+  };
+
+  std::vector<Entry> m_Entries;
+  std::vector<uint32_t> m_Slots;  // entry index + 1, 0 for an empty slot
+  std::vector<uint32_t> m_Free;   // cleared entries, reused before growing
+  size_t m_Count;
+
+  // FNV's low bits are weak on short, similar names; fold in the high half
+  static size_t Mix(uint64_t hash) { return (size_t)(hash ^ (hash >> 32)); }
+
+  static void NextGeneration(Entry& entry) {
+    if (++entry.generation == 0) {
+      entry.generation = 1;
+    }
+  }
+
+  void Place(uint32_t index) {
+    size_t mask = m_Slots.size() - 1;
+    size_t slot = Mix(m_Entries[index].hash) & mask;
+    while (m_Slots[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    m_Slots[slot] = index + 1;
+  }
+
+  void Rehash(size_t slotCount) {
+    m_Slots.assign(slotCount, 0);
+    for (uint32_t index = 0; index < (uint32_t)m_Entries.size(); index++) {
+      if (m_Entries[index].live) {
+        Place(index);
+      }
+    }
+  }
+};
+
+#endif // ASSETTABLE_H
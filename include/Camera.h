@@ -9,6 +9,9 @@ public:
   
   glm::mat4 GetViewMatrix() const;
   glm::mat4 GetProjectionMatrix(int screenWidth, int screenHeight) const;
+  // World space area the camera sees as (minX, minY, maxX, maxY), grown by
+  // margin on every side
+  glm::vec4 GetViewRect(float margin = 0.0f) const;
   
   void Follow(const glm::vec2& targetPosition, float deltaTime);
   
@@ -0,0 +1,88 @@
+#ifndef DEBUGDRAW_H
+#define DEBUGDRAW_H
+
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Immediate-mode debug primitives in world space. Calls made anywhere during
+// a frame are accumulated on the CPU and Flush draws all of them with one
+// GL_LINES and one GL_TRIANGLES draw through the vertex stream. Game thread
+// only. Built only with LEO_DEBUG_DRAW defined (CMake option of the same
+// name); otherwise every call is an empty inline function.
+#ifdef LEO_DEBUG_DRAW
+
+class DebugDraw {
+public:
+  DebugDraw();
+  ~DebugDraw();
+
+  // Owned by Renderer, which makes it current in Init. The static calls
+  // below do nothing while there is no current instance.
+  static DebugDraw* Get() { return s_Current; }
+  static void SetCurrent(DebugDraw* debugDraw) { s_Current = debugDraw; }
+
+  // solidShader is the Solid batch shader variant (position, uv, color at 0-2)
+  bool Init(Shader* solidShader, StreamBuffer* vertexStream);
+  void Cleanup();
+
+  static void Line(glm::vec2 from, glm::vec2 to, glm::vec4 color);
+  // box is (centerX, centerY, width, height), as GameObject::GetBoundingBox
+  static void Rect(const glm::vec4& box, glm::vec4 color, bool filled = false);
+  static void Circle(glm::vec2 center, float radius, glm::vec4 color, bool filled = false);
+  // Upper case 3x5 pixel font, top-left at position; pixelSize is in world units
+  static void Text(glm::vec2 position, const char* text, glm::vec4 color,
+                   float pixelSize = 2.0f);
+
+  // Draws and clears everything queued since the last Flush, with the
+  // currently bound camera space
+  void Flush();
+
+  // Counts of the last Flush
+  int GetLineCount() const { return m_LastLineCount; }
+  int GetTriangleCount() const { return m_LastTriangleCount; }
+
+private:
+  // Color is normalized RGBA8, so a vertex is 12 bytes
+  struct DebugVertex {
+    glm::vec2 position;
+    uint32_t color;
+  };
+
+  static constexpr int kCircleSegments = 24;
+  // Per draw; a multiple of 2 and 3 that fits a vertex stream region
+  static constexpr size_t kMaxVerticesPerDraw = 3 * 65536;
+
+  static DebugDraw* s_Current;
+
+  Shader* m_Shader;
+  StreamBuffer* m_VertexStream;
+  GLuint m_VAO;
+  std::vector<DebugVertex> m_LineVertices;
+  std::vector<DebugVertex> m_TriangleVertices;
+  glm::vec2 m_CircleOutline[kCircleSegments + 1];
+  int m_LastLineCount;
+  int m_LastTriangleCount;
+
+  static uint32_t PackColor(glm::vec4 color);
+  void AddLine(glm::vec2 from, glm::vec2 to, uint32_t color);
+  void AddQuad(glm::vec2 min, glm::vec2 max, uint32_t color);
+  void DrawVertices(GLenum mode, const std::vector<DebugVertex>& vertices);
+};
+
+#else
+
+class DebugDraw {
+public:
+  static void Line(glm::vec2, glm::vec2, glm::vec4) {}
+  static void Rect(const glm::vec4&, glm::vec4, bool = false) {}
+  static void Circle(glm::vec2, float, glm::vec4, bool = false) {}
+  static void Text(glm::vec2, const char*, glm::vec4, float = 2.0f) {}
+};
+
+#endif // LEO_DEBUG_DRAW
+
+#endif // DEBUGDRAW_H
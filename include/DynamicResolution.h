@@ -0,0 +1,58 @@
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include "SpriteBatch.h"
+#include <GL/glew.h>
+
+// Offscreen color target for the world passes whose resolution follows a
+// frame time budget. The texture is allocated once at full size and the
+// scaled image is rendered into its lower-left corner, so changing the scale
+// never reallocates. Composite stretches that corner over the window.
+//
+// The controller smooths the measured frame time, lowers the scale by the
+// square root of the budget overrun (cost follows pixel count) and raises it
+// one step at a time once there is clear headroom. After each change it waits
+// kCooldownFrames, longer than RenderStats' GPU timing latency, before
+// judging again.
+class DynamicResolution {
+public:
+  DynamicResolution();
+  ~DynamicResolution();
+
+  bool Init(int width, int height, double budgetMs, float minScale = 0.5f);
+  void Cleanup();
+
+  // One measured frame time in milliseconds per frame
+  void Update(double frameMs);
+
+  // Redirects rendering into the scaled target; End returns to the default
+  // framebuffer at full size
+  void Begin();
+  void End();
+  // Draws the target over the whole window through batch. Screen space must
+  // be bound; blending is off while compositing.
+  void Composite(SpriteBatch& batch);
+
+  float GetScale() const { return m_Scale; }
+  int GetScaledWidth() const;
+  int GetScaledHeight() const;
+
+private:
+  static constexpr float kScaleStep = 0.05f;
+  static constexpr int kCooldownFrames = 8;
+  static constexpr double kSmoothing = 0.1;
+  // Raise only below this fraction of the budget, so the scale does not
+  // oscillate around the budget
+  static constexpr double kRaiseThreshold = 0.8;
+
+  GLuint m_FBO;
+  GLuint m_ColorTexture;
+  int m_Width, m_Height;
+  double m_BudgetMs;
+  float m_MinScale;
+  float m_Scale;
+  double m_SmoothedMs;
+  int m_FramesSinceChange;
+};
+
+#endif // DYNAMICRESOLUTION_H
@@ -0,0 +1,92 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <GL/glew.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records the window contents without stalling the render thread.
+//
+// Capture() queues an asynchronous glReadPixels into one pixel buffer object
+// of a ring and fences it. A slot's pixels are mapped when the ring comes
+// back to it kRingSize frames later, once the GPU has long finished the copy,
+// and handed to a writer thread that flips them top-down and writes them out.
+// The render thread only pays for the read command and one memcpy per frame.
+//
+// The target selects the output:
+//   "|command"   raw RGBA frames piped to command's stdin, e.g. an encoder
+//   "*.raw"      raw RGBA frames appended to one file
+//   otherwise    a PNG sequence, target_000000.png, target_000001.png, ...
+//
+// If the writer falls more than kMaxQueuedFrames behind, frames are dropped
+// rather than blocking the render thread; GetDroppedCount reports them. If a
+// write fails, e.g. the encoder exited, capture stops and the game carries on.
+class FrameCapture {
+public:
+  static constexpr int kRingSize = 3;
+  static constexpr int kMaxQueuedFrames = 8;
+
+  FrameCapture();
+  ~FrameCapture();
+
+  bool Init(int width, int height, const std::string& target);
+  // Writes the frames still in flight and stops the writer
+  void Cleanup();
+
+  // Reads the current draw framebuffer; call after the last draw of the
+  // frame and before swapping
+  void Capture();
+
+  int GetCapturedCount() const { return m_Captured; }
+  int GetDroppedCount() const { return m_Dropped; }
+  // Render thread time spent in the last Capture()
+  double GetLastCaptureMs() const { return m_LastCaptureMs; }
+
+private:
+  enum class Output { PNG, Raw, Pipe };
+
+  struct Slot {
+    GLuint buffer;
+    GLsync fence;  // Null when the slot holds no pending frame
+    int frame;
+  };
+
+  struct Frame {
+    int index;
+    std::vector<uint8_t> pixels;  // Bottom-up, as GL reads them
+  };
+
+  int m_Width, m_Height;
+  size_t m_FrameBytes;
+  Output m_Output;
+  std::string m_Target;
+  FILE* m_File;
+
+  Slot m_Slots[kRingSize];
+  int m_NextSlot;
+  int m_Captured;
+  int m_Dropped;
+  double m_LastCaptureMs;
+
+  std::thread m_Writer;
+  std::mutex m_Mutex;
+  std::condition_variable m_FrameReady;
+  std::deque<Frame> m_Queue;
+  std::vector<std::vector<uint8_t>> m_FreeBuffers;  // Recycled pixel storage
+  bool m_Stopping;
+  std::atomic<bool> m_Failed;  // Set by the writer; Capture() stops reading
+
+  void Collect(Slot& slot);
+  void WriterLoop();
+  // False when the output can take no more frames
+  bool WriteFrame(const Frame& frame, std::vector<uint8_t>& flipped);
+};
+
+#endif // FRAMECAPTURE_H
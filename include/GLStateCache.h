@@ -0,0 +1,72 @@
+#ifndef GLSTATECACHE_H
+#define GLSTATECACHE_H
+
+#include <GL/glew.h>
+
+// Shadow copy of the GL binding state. Every bind in the engine goes through
+// it and calls whose target state is already current are skipped. Owned by
+// Renderer, which makes it current in Init; code without a Renderer at hand
+// reaches it through GLStateCache::Get().
+class GLStateCache {
+public:
+  static constexpr int kMaxTextureUnits = 8;
+  static constexpr int kMaxUniformBindings = 4;
+
+  GLStateCache();
+
+  static GLStateCache* Get() { return s_Current; }
+  static void SetCurrent(GLStateCache* cache) { s_Current = cache; }
+
+  // Forget everything, e.g. after third-party code touched GL directly
+  void Invalidate();
+
+  void UseProgram(GLuint program);
+  void BindVertexArray(GLuint vertexArray);
+  void ActiveTexture(GLenum unit);
+  void BindTexture(GLuint texture);
+  void BindTexture(GLenum unit, GLuint texture);
+  // Other texture targets; GL_TEXTURE_2D and GL_TEXTURE_BUFFER are cached
+  void BindTexture(GLenum unit, GLenum target, GLuint texture);
+  void BindBuffer(GLenum target, GLuint buffer);
+  void BindBufferRange(GLenum target, GLuint index, GLuint buffer,
+                       GLintptr offset, GLsizeiptr size);
+
+  // Delete and drop the object from the cache, GL unbinds deleted objects
+  void DeleteTexture(GLuint texture);
+  void DeleteBuffer(GLuint buffer);
+  void DeleteVertexArray(GLuint vertexArray);
+  void DeleteProgram(GLuint program);
+
+  void ResetCounters();
+  int GetIssuedCount() const { return m_Issued; }
+  int GetSkippedCount() const { return m_Skipped; }
+
+private:
+  struct BufferRange {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+  };
+
+  static GLStateCache* s_Current;
+
+  GLuint m_Program;
+  GLuint m_VertexArray;
+  int m_ActiveUnit;
+  GLuint m_Textures[kMaxTextureUnits];        // GL_TEXTURE_2D
+  GLuint m_BufferTextures[kMaxTextureUnits];  // GL_TEXTURE_BUFFER
+  GLuint m_ArrayBuffer;
+  GLuint m_UniformBuffer;
+  GLuint m_PixelPackBuffer;
+  GLuint m_PixelUnpackBuffer;
+  BufferRange m_UniformRanges[kMaxUniformBindings];
+
+  int m_Issued;
+  int m_Skipped;
+
+  GLuint* BufferSlot(GLenum target);
+  GLuint* TextureSlot(GLenum target, int unit);
+  bool Track(GLuint& current, GLuint value);
+};
+
+#endif // GLSTATECACHE_H
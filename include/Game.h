@@ -3,15 +3,22 @@
 
 #include "Renderer.h"
 #include "InputManager.h"
+#include "LayerCache.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "ParticleSystem.h"
 #include "ResourceManager.h"
 #include "Scene.h"
 #include "Camera.h"
+#include "ThreadPool.h"
+#include "Tilemap.h"
 #include <GL/glew.h>
 #include <SDL.h>
 #include <SDL_mixer.h>
 #include <SDL_ttf.h>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <string>
 
 class Game {
 public:
@@ -21,11 +28,65 @@ public:
   void Init(const char *title, int width, int height, bool fullscreen);
   void HandleEvents();
   void Update(float deltaTime);
+  // Draws and presents a frame, unless nothing visible changed since the
+  // last one
   void Render();
   void Clean();
 
+  // Blocks until an event arrives or something is due to change on screen,
+  // when the last rendered frame is still current. Returns at once otherwise
+  void WaitForActivity();
+
   bool Running() { return isRunning; }
 
+  // Spawns spriteCount extra sprites and reports draw calls / frame time.
+  // Must be called before Init.
+  void SetBenchmark(int spriteCount) { m_BenchmarkSprites = spriteCount; }
+  // Adds a mapSize x mapSize tile ground layer and reports chunk counts.
+  // Must be called before Init.
+  void SetTileBenchmark(int mapSize) { m_BenchmarkTiles = mapSize; }
+  // Runs emitters that keep about particleCount particles alive and reports
+  // the particle update time. Must be called before Init.
+  void SetParticleBenchmark(int particleCount) { m_BenchmarkParticles = particleCount; }
+  // Dims the scene and moves lightCount point lights through it, reporting
+  // the light grid's visible and per-tile counts. Must be called before Init.
+  void SetLightBenchmark(int lightCount) { m_BenchmarkLights = lightCount; }
+  // Spawns spriteCount walking knights animated on the GPU. Must be called
+  // before Init.
+  void SetAnimationBenchmark(int spriteCount) { m_BenchmarkAnimated = spriteCount; }
+  // Streams textureCount textures in asynchronously, each shown on a sprite,
+  // and reports the worst frame time while they load. Must be called before
+  // Init.
+  void SetStreamingBenchmark(int textureCount) { m_BenchmarkStreaming = textureCount; }
+  // Prints render statistics every second and/or writes one CSV row per
+  // frame. Must be called before Init.
+  void SetRenderStats(bool print, const std::string& csvPath) {
+    m_PrintRenderStats = print;
+    m_RenderStatsCSV = csvPath;
+  }
+  // Selects the SpriteBatch path (CPU vertices or hardware instancing).
+  // Must be called before Init.
+  void SetSpriteBatchMode(SpriteBatchMode mode) { m_SpriteBatchMode = mode; }
+  // Starts with the collision debug overlay shown; F1 toggles it. Needs a
+  // LEO_DEBUG_DRAW build.
+  void SetDebugOverlay(bool show) { m_ShowDebugOverlay = show; }
+  // Renders the world passes offscreen at a scale that keeps the frame time
+  // near budgetMs, then upscales; UI stays at native resolution. 0 renders
+  // straight to the window. Must be called before Init.
+  void SetDynamicResolution(double budgetMs) { m_ResolutionBudgetMs = budgetMs; }
+  // Records every frame to target (see FrameCapture for the formats). Must
+  // be called before Init.
+  void SetCapture(const std::string& target) { m_CaptureTarget = target; }
+  // Draws static scene layers from cached images (default) or every frame
+  void SetLayerCache(bool enabled) { m_UseLayerCache = enabled; }
+  // Cooked asset pack to map at startup (default assets.pak, built by the
+  // cook_assets target); empty loads loose files only. Must be called
+  // before Init.
+  void SetAssetPack(const std::string& path) { m_AssetPackPath = path; }
+  // Skips rendering frames identical to the last one and sleeps in
+  // WaitForActivity (default) or renders continuously
+  void SetIdleSkip(bool enabled) { m_IdleSkip = enabled; }
+
 private:
   bool isRunning;
   SDL_Window *window;
@@ -36,15 +97,74 @@ private:
   ResourceManager* m_ResourceManager;
   Scene* m_Scene;
   Camera* m_Camera;
+  ThreadPool* m_ThreadPool;
+  Tilemap* m_Tilemap;
+  ParticleSystem* m_Particles;
+  DynamicResolution* m_DynamicResolution;
+  FrameCapture* m_FrameCapture;
+  LayerCache* m_LayerCaches[kRenderLayerCount];  // static layers only
+  bool m_UseLayerCache;
   
   int m_ScreenWidth;
   int m_ScreenHeight;
   bool m_WasColliding;
+  SoundHandle m_JumpSound;
+  SoundHandle m_CollisionSound;
+  SpriteBatchMode m_SpriteBatchMode;
+  bool m_PrintRenderStats;
+  std::string m_RenderStatsCSV;
+  bool m_ShowDebugOverlay;
+  double m_ResolutionBudgetMs;
+  std::string m_CaptureTarget;
+  std::string m_AssetPackPath;
+  std::string m_ScoreText;
+
+  // What the last rendered frame showed, to detect idle frames
+  bool m_IdleSkip;
+  bool m_Dirty;  // set by changes not covered by the fields below
+  uint32_t m_DrawnSceneRevision;
+  glm::vec2 m_DrawnCameraPosition;
+  std::string m_DrawnScoreText;
+  // Longest idle sleep; bounds how late a change that sends no event is seen
+  static constexpr int kMaxIdleWaitMs = 100;
+
+  // Below this many objects per chunk, recording on one thread is cheaper
+  // than waking workers
+  static constexpr size_t kObjectsPerRecordChunk = 512;
+  // GL thread time per frame for streamed texture uploads
+  static constexpr double kTextureUploadBudgetMs = 2.0;
+
+  static constexpr double kBenchmarkDurationSeconds = 10.0;
+  int m_BenchmarkSprites;
+  int m_BenchmarkTiles;
+  int m_BenchmarkParticles;
+  int m_BenchmarkLights;
+  int m_BenchmarkAnimated;
+  int m_BenchmarkStreaming;
+  float m_LightTime;
+  Uint64 m_BenchStartCounter;
+  Uint64 m_BenchLastCounter;
+  int m_BenchFrames;
+  double m_BenchFrameTimeMs;
+  double m_BenchWorstFrameMs;
+  int m_BenchTotalFrames;
+  double m_BenchTotalFrameTimeMs;
   
   void InitSDL();
   void InitOpenGL();
   void InitResources();
   void InitScene();
+  void InitTilemap();
+  void InitParticles();
+  bool IsBenchmarking() const {
+    return m_BenchmarkSprites > 0 || m_BenchmarkTiles > 0 || m_BenchmarkParticles > 0 ||
+           m_BenchmarkLights > 0 || m_BenchmarkAnimated > 0 || m_BenchmarkStreaming > 0;
+  }
+  bool NeedsRender() const;
+  void UpdateBenchmark();
+  void SubmitLights(float deltaTime);
+  void UpdateLayerCaches(const glm::vec4& viewRect);
+  void DrawDebugOverlay(const std::vector<uint32_t>& visible, const glm::vec4& viewRect);
 };
 
 #endif // GAME_H
@@ -2,27 +2,42 @@
 #define GAMEOBJECT_H
 
 #include "Texture.h"
+#include "RenderQueue.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
 class Animation;
+class ResourceManager;
 
 class GameObject {
 public:
-  GameObject(glm::vec2 position, glm::vec2 size, Texture* texture);
+  GameObject(glm::vec2 position, glm::vec2 size, TextureHandle texture);
   ~GameObject();
 
   void Update(float deltaTime);
-  void Draw(const glm::mat4& view, const glm::mat4& projection, 
-            GLuint shaderProgram, GLuint VAO, int indexCount = 6,
-            bool useColor = false, glm::vec4 color = glm::vec4(1.0f));
+  // Queues this object using its render properties below, resolving its
+  // texture through resources
+  void Draw(RenderQueue& queue, const ResourceManager& resources) const;
 
   glm::vec4 GetBoundingBox() const;
+  // Area Draw covers (minX, minY, maxX, maxY); culling relies on it
+  glm::vec4 GetDrawBounds() const;
 
   glm::vec2 position;
-  glm::vec2 size;
-  Texture* texture;
-  Animation* currentAnimation;
+  glm::vec2 size;  // full width and height, centered on position, for every shape
+  TextureHandle texture;  // null handle for solid shapes
+  Animation* currentAnimation;  // stepped on the CPU every Update
+  // AnimationClips clip played on the GPU from animationStart (clock
+  // seconds); -1 for none. Takes precedence over currentAnimation
+  int animationClip;
+  float animationStart;
+
+  // Render properties
+  RenderLayer layer;
+  SpriteShape shape;     // anything but Quad is drawn solid in color
+  float shapeParameter;  // ring thickness or corner radius
+  bool useColor;         // draw a solid shape in color instead of the texture
+  glm::vec4 color;
 };
 
 #endif // GAMEOBJECT_H
@@ -0,0 +1,48 @@
+#ifndef LAYERCACHE_H
+#define LAYERCACHE_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Offscreen image of one static layer over a world region larger than the
+// view, drawn in place of the layer's objects. It stays valid while the view
+// is inside the region and the layer's revision is unchanged.
+//
+// Rebuild: BeginRebuild binds the target, clears it transparent and blends
+// in premultiplied alpha; draw the layer with the Region camera set to
+// GetRegion(); EndRebuild restores the window framebuffer.
+class LayerCache {
+public:
+  LayerCache();
+  ~LayerCache();
+
+  // The region is the view grown by paddingFraction of its size on every
+  // side, at one texel per screen pixel
+  bool Init(int screenWidth, int screenHeight, float paddingFraction = 0.5f);
+  void Cleanup();
+
+  bool IsValid(const glm::vec4& viewRect, uint32_t revision) const;
+  void Invalidate() { m_Valid = false; }
+
+  // Centers the region on viewRect; revision is the layer's at this time
+  void BeginRebuild(const glm::vec4& viewRect, uint32_t revision);
+  void EndRebuild();
+
+  GLuint GetTexture() const { return m_ColorTexture; }
+  // (minX, minY, maxX, maxY) in world units
+  const glm::vec4& GetRegion() const { return m_Region; }
+  int GetRebuildCount() const { return m_Rebuilds; }
+
+private:
+  GLuint m_FBO;
+  GLuint m_ColorTexture;
+  int m_ScreenWidth, m_ScreenHeight;
+  int m_Width, m_Height;
+  glm::vec4 m_Region;
+  uint32_t m_Revision;
+  bool m_Valid;
+  int m_Rebuilds;
+};
+
+#endif // LAYERCACHE_H
@@ -0,0 +1,86 @@
+#ifndef LIGHTGRID_H
+#define LIGHTGRID_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+struct PointLight {
+  glm::vec2 position;
+  float radius;     // No light at or beyond this distance
+  glm::vec3 color;  // Premultiplied by intensity
+};
+
+// Lighting fields of the camera uniform block (std140, after view and
+// projection). Zero in blocks that draw unlit.
+struct LightingBlock {
+  glm::vec4 grid;     // World origin of tile (0, 0) (xy), tiles per world unit (z), lit (w)
+  glm::vec4 gridSize; // Tile columns (x) and rows (y)
+  glm::vec4 ambient;  // Light every lit pixel gets (rgb)
+};
+
+// 2D point lights culled on the CPU into screen-space tiles, so each pixel
+// only shades the lights whose radius reaches its tile: the cost per pixel
+// follows the local light density, not the total light count.
+//
+// Lights are submitted every frame, like draws. Build bins them into the
+// tiles of the view and uploads two buffer textures:
+//   - lights: two RGBA32F texels per visible light, (x, y, 1/radius^2, 0)
+//     and (color, 0)
+//   - tiles: R32UI, tileCount + 1 start offsets followed by the light
+//     indices; tile t's lights are entries [start[t], start[t + 1])
+class LightGrid {
+public:
+  static constexpr int kTileSize = 32;  // Screen pixels per tile side
+  // Texture units the buffers stay bound to; 0 is the sprite texture
+  static constexpr int kLightDataUnit = 1;
+  static constexpr int kLightTilesUnit = 2;
+
+  LightGrid();
+  ~LightGrid();
+
+  bool Init();
+  void Cleanup();
+
+  // Off by default; with lighting off, the world draws unlit
+  void SetEnabled(bool enabled) { m_Enabled = enabled; }
+  bool IsEnabled() const { return m_Enabled; }
+  void SetAmbient(glm::vec3 ambient) { m_Ambient = ambient; }
+
+  void AddLight(glm::vec2 position, float radius, glm::vec3 color, float intensity = 1.0f);
+
+  // Culls this frame's lights against the tiles of viewRect, which covers
+  // screenWidth x screenHeight pixels, uploads the result and clears the
+  // light list for the next frame
+  void Build(const glm::vec4& viewRect, int screenWidth, int screenHeight);
+  const LightingBlock& GetBlock() const { return m_Block; }
+
+  int GetLightCount() const { return m_LastLightCount; }
+  int GetVisibleLightCount() const { return m_LastVisibleCount; }
+  int GetMaxTileLightCount() const { return m_LastMaxTileCount; }
+
+private:
+  struct TileEntry {
+    uint32_t tile;
+    uint32_t light;
+  };
+
+  bool m_Enabled;
+  glm::vec3 m_Ambient;
+  GLint m_MaxTexels;
+  GLuint m_LightBuffer, m_LightTexture;
+  GLuint m_TileBuffer, m_TileTexture;
+  LightingBlock m_Block;
+
+  std::vector<PointLight> m_Lights;
+  std::vector<glm::vec4> m_LightData;
+  std::vector<TileEntry> m_Entries;
+  std::vector<uint32_t> m_TileData;
+
+  int m_LastLightCount;
+  int m_LastVisibleCount;
+  int m_LastMaxTileCount;
+};
+
+#endif // LIGHTGRID_H
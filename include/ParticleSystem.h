@@ -0,0 +1,105 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include "SpriteBatch.h"
+#include "StreamBuffer.h"
+#include "ThreadPool.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Spawn parameters of an emitter; ranges are picked uniformly per particle
+struct EmitterSettings {
+  glm::vec2 position = glm::vec2(0.0f);
+  float rate = 100.0f;              // particles per second
+  float minLifetime = 1.0f, maxLifetime = 2.0f;
+  float minSpeed = 50.0f, maxSpeed = 100.0f;
+  float direction = 0.0f;           // radians, 0 points along +x
+  float spread = 6.2831853f;        // full cone angle in radians
+  glm::vec2 gravity = glm::vec2(0.0f);
+  float minSize = 4.0f, maxSize = 8.0f;
+  glm::vec4 minColor = glm::vec4(1.0f), maxColor = glm::vec4(1.0f);
+  GLuint texture = 0;               // 0 draws solid shapes
+  SpriteShape shape = SpriteShape::Quad;  // solid only; size is the full width
+};
+
+// Fixed-capacity particle pool stored as structure of arrays, so the update
+// touches tightly packed floats only and vectorizes 4 lanes at a time.
+// Particles fade out over their lifetime and are removed by swapping the
+// last live particle into their slot; order is not preserved.
+class ParticleEmitter {
+public:
+  static constexpr int kMaxCapacity = 65536;
+
+  ParticleEmitter(const EmitterSettings& settings, int capacity);
+
+  EmitterSettings& GetSettings() { return m_Settings; }
+  void SetEmitting(bool emitting) { m_Emitting = emitting; }
+
+  // Spawns rate * deltaTime particles, then integrates and compacts. Large
+  // pools are integrated in kParticlesPerChunk slices on the thread pool.
+  void Update(float deltaTime, ThreadPool* pool);
+  // Writes every live particle into the vertex stream and draws them with
+  // one instanced draw per kMaxInstancesPerDraw
+  void Draw(SpriteBatch& batch, StreamBuffer& vertexStream, ThreadPool* pool);
+
+  int GetCount() const { return m_Count; }
+  int GetCapacity() const { return m_Capacity; }
+
+private:
+  // Below this many particles per slice, waking workers costs more than the
+  // slice itself
+  static constexpr int kParticlesPerChunk = 8192;
+  // Largest slice written in one stream mapping (768 KB of instances), well
+  // below a Renderer vertex stream region so full emitters never wrap the
+  // ring within a frame on their own
+  static constexpr int kMaxInstancesPerDraw = 16384;
+
+  EmitterSettings m_Settings;
+  int m_Capacity;
+  int m_Count;
+  bool m_Emitting;
+  float m_SpawnAccumulator;
+  uint32_t m_RandomState;
+
+  std::vector<float> m_PositionX, m_PositionY;
+  std::vector<float> m_VelocityX, m_VelocityY;
+  std::vector<float> m_Life;             // seconds left
+  std::vector<float> m_InverseLifetime;  // 1 / total lifetime
+  std::vector<float> m_Size;
+  std::vector<float> m_ColorR, m_ColorG, m_ColorB, m_ColorA;
+
+  void Spawn(int count);
+  void Integrate(float deltaTime, int begin, int end);
+  void Compact();
+  // Writes particles [begin, end) to out, where out[0] is particle first
+  void WriteInstances(SpriteInstance* out, int first, int begin, int end) const;
+  float Random(float min, float max);
+  size_t ChunkCount(ThreadPool* pool, int count) const;
+};
+
+// Owns the emitters of a scene and updates/draws them together
+class ParticleSystem {
+public:
+  ParticleSystem();
+  ~ParticleSystem();
+
+  // Capacity is clamped to ParticleEmitter::kMaxCapacity
+  ParticleEmitter* AddEmitter(const EmitterSettings& settings, int capacity);
+  void Cleanup();
+
+  void Update(float deltaTime, ThreadPool* pool);
+  // Draws with the currently bound camera space
+  void Draw(SpriteBatch& batch, StreamBuffer& vertexStream, ThreadPool* pool);
+
+  int GetLiveCount() const;
+  // Wall time of the last Update in milliseconds
+  double GetUpdateMs() const { return m_UpdateMs; }
+
+private:
+  std::vector<ParticleEmitter*> m_Emitters;
+  double m_UpdateMs;
+};
+
+#endif // PARTICLESYSTEM_H
@@ -0,0 +1,25 @@
+#ifndef RENDERBACKEND_H
+#define RENDERBACKEND_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Where sorted sprites end up. SpriteBatch draws them with OpenGL;
+// SoftwareRasterizer draws them on the CPU, without a GL context. Texture
+// names are opaque to RenderQueue: GL texture names for SpriteBatch, ids
+// from SoftwareRasterizer::AddTexture for the rasterizer, 0 for solid
+// sprites in both.
+class RenderBackend {
+public:
+  virtual ~RenderBackend() = default;
+
+  virtual void Begin() = 0;
+  virtual void End() = 0;
+
+  // uvRect is a texture rect, SpriteBatch::ShapeParams for texture 0 or
+  // SpriteBatch::AnimationParams for an animated sprite
+  virtual void SubmitQuad(GLuint texture, glm::vec2 position, glm::vec2 size,
+                          glm::vec4 uvRect, glm::vec4 color) = 0;
+};
+
+#endif // RENDERBACKEND_H
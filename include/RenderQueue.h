@@ -0,0 +1,88 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "RenderBackend.h"
+#include "SpriteBatch.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Coarse draw order, lowest first
+enum class RenderLayer : uint8_t {
+  Background = 0,
+  World = 1,
+  Foreground = 2
+};
+constexpr int kRenderLayerCount = 3;
+
+// One sprite waiting to be drawn, ordered by key
+struct DrawPacket {
+  uint64_t key;
+  GLuint texture;
+  glm::vec2 position;
+  glm::vec2 size;
+  glm::vec4 uvRect;  // SpriteBatch::ShapeParams when texture is 0
+  glm::vec4 color;
+};
+
+// Collects draw packets for a frame, radix-sorts them by a 64-bit key and
+// feeds them to a render backend (normally the SpriteBatch) in that order.
+// Recording touches no GL state, so worker threads can each fill their own
+// queue (command list) and the GL thread Appends them into one before
+// flushing.
+//
+// Key layout, high bits first:
+//   layer (8) | depth (24) | translucent (1) | shader (7) | texture (24)
+// There is no depth test, so within a layer every packet is drawn back to
+// front (lower depth first) and only groups by state at equal depth, opaque
+// before translucent. Depth is the sprite's bottom edge Y for top-down
+// sorting; sprites on a shared row still batch.
+class RenderQueue {
+public:
+  RenderQueue();
+
+  static uint64_t MakeKey(RenderLayer layer, bool translucent, uint32_t shader,
+                          GLuint texture, float depth);
+
+  void Submit(const DrawPacket& packet);
+  void SubmitQuad(RenderLayer layer, bool translucent, float depth, GLuint texture,
+                  glm::vec2 position, glm::vec2 size,
+                  glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                  glm::vec4 color = glm::vec4(1.0f));
+  // Solid shapes have antialiased edges, so pass translucent unless the
+  // shape is a plain Quad
+  void SubmitShape(RenderLayer layer, bool translucent, float depth, SpriteShape shape,
+                   glm::vec2 position, glm::vec2 size, glm::vec4 color,
+                   float parameter = 0.0f);
+
+  // Copies other's packets after this queue's own. Appending command lists in
+  // a fixed order keeps the sorted result deterministic (the sort is stable).
+  void Append(const RenderQueue& other);
+
+  // Sorts and submits every packet into backend (between its Begin/End),
+  // then empties the queue. beginLayer, if set, runs before each layer's
+  // packets, for every layer in order even when it has none.
+  void Flush(RenderBackend& backend,
+             const std::function<void(RenderLayer)>& beginLayer = nullptr);
+  void Clear();
+
+  size_t GetPacketCount() const { return m_Packets.size(); }
+
+private:
+  struct SortEntry {
+    uint64_t key;
+    uint32_t index;
+  };
+
+  std::vector<DrawPacket> m_Packets;
+  std::vector<SortEntry> m_Entries;
+  std::vector<SortEntry> m_Scratch;
+
+  static uint32_t ShaderBits(GLuint texture);
+  static uint32_t DepthBits(float depth);
+  void Sort();
+};
+
+#endif // RENDERQUEUE_H
@@ -0,0 +1,102 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <GL/glew.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+// Counters and GPU timings of one frame
+struct FrameStats {
+  static constexpr int kMaxPasses = 8;
+
+  uint64_t frame;
+  double cpuFrameMs;
+  int drawCalls;
+  int triangles;
+  int stateChangesIssued;
+  int stateChangesSkipped;
+  int textureUploads;
+  size_t textureUploadBytes;
+  size_t bytesStreamed;
+  int objectsDrawn;
+  int glyphsDrawn;
+  double gpuPassMs[kMaxPasses]; // -1 when the pass did not run or timed out
+};
+
+// Per-frame render statistics. Owned by Renderer, which makes it current in
+// Init; Texture, TextRenderer, SpriteBatch, GameObject and friends report
+// into it through RenderStats::Get(). GPU passes are timed with
+// GL_TIME_ELAPSED queries that are read kQueryLatency frames later, and only
+// if already available, so collecting never stalls the pipeline.
+class RenderStats {
+public:
+  static constexpr int kQueryLatency = 4;
+
+  RenderStats();
+
+  static RenderStats* Get() { return s_Current; }
+  static void SetCurrent(RenderStats* stats) { s_Current = stats; }
+
+  void Init();
+  void Cleanup();
+
+  void BeginFrame();
+  // stateIssued/stateSkipped come from the GLStateCache counters
+  void EndFrame(int stateIssued, int stateSkipped);
+
+  // GPU timed section; passes cannot nest. Names must be string literals or
+  // otherwise outlive the stats.
+  void BeginPass(const char* name);
+  void EndPass();
+
+  void AddDrawCall(int triangles);
+  void AddTextureUpload(size_t bytes);
+  void AddStreamedBytes(size_t bytes);
+  void AddGlyphsDrawn(int glyphs);
+  // Called from render recording threads, hence atomic
+  void AddObjectDrawn() { m_ObjectsDrawn.fetch_add(1, std::memory_order_relaxed); }
+
+  // Latest frame whose GPU timings are known (kQueryLatency frames old)
+  const FrameStats& GetResolvedFrame() const { return m_Resolved; }
+  int GetPassCount() const { return m_PassCount; }
+  const char* GetPassName(int pass) const { return m_PassNames[pass]; }
+
+  // Prints the resolved frame every interval seconds (0 disables)
+  void SetPrintInterval(double seconds) { m_PrintInterval = seconds; }
+  void Print(std::ostream& out) const;
+  // Appends one row per resolved frame; passes are columns in first-use order
+  bool OpenCSV(const std::string& path);
+  void CloseCSV();
+
+private:
+  static RenderStats* s_Current;
+
+  FrameStats m_Frames[kQueryLatency]; // in flight, indexed by frame % latency
+  FrameStats m_Resolved;
+  bool m_HasResolved;
+  uint64_t m_FrameNumber;
+  std::atomic<int> m_ObjectsDrawn;
+
+  GLuint m_Queries[kQueryLatency][FrameStats::kMaxPasses];
+  bool m_QueryIssued[kQueryLatency][FrameStats::kMaxPasses];
+  const char* m_PassNames[FrameStats::kMaxPasses];
+  int m_PassCount;
+  int m_ActivePass;
+
+  std::chrono::steady_clock::time_point m_FrameStart;
+  std::chrono::steady_clock::time_point m_LastPrint;
+  double m_PrintInterval;
+  std::ofstream m_CSV;
+  bool m_CSVHeaderWritten;
+
+  FrameStats& Current() { return m_Frames[m_FrameNumber % kQueryLatency]; }
+  void Resolve(int slot);
+  void WriteCSVRow(const FrameStats& stats);
+};
+
+#endif // RENDERSTATS_H
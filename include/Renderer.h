@@ -1,8 +1,34 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include "AnimationClips.h"
+#include "Camera.h"
+#include "DebugDraw.h"
+#include "GLStateCache.h"
+#include "LightGrid.h"
+#include "RenderQueue.h"
+#include "RenderStats.h"
+#include "Shader.h"
+#include "SpriteBatch.h"
+#include "StreamBuffer.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <vector>
+
+// Compile-time shader variants; Solid has no texture fetch at all
+enum class ShaderVariant {
+  Textured = 0,
+  Solid = 1
+};
+
+// Which view/projection pair of the camera uniform block is bound
+enum class CameraSpace {
+  World,      // Camera view, world units, lit by the light grid
+  Screen,     // Identity view, pixel coordinates for UI
+  Region,     // World units of the rect last given to UpdateRegionCamera
+  WorldUnlit  // Camera view without lighting, for overlays
+};
+constexpr int kCameraSpaceCount = 4;
 
 class Renderer {
 public:
@@ -12,22 +38,89 @@ public:
   bool Init();
   void Cleanup();
 
-  GLuint GetShaderProgram() const { return m_ShaderProgram; }
+  // Frame bracket: resets per-frame counters and collects RenderStats
+  void BeginFrame();
+  void EndFrame();
+
+  // Uploads the world and screen space matrices and the animation clock
+  // once per frame, and builds the light grid from the lights submitted
+  // since the last call
+  void UpdateCamera(const Camera& camera, int screenWidth, int screenHeight);
+  void UseCameraSpace(CameraSpace space);
+  // Maps the world rect (minX, minY, maxX, maxY) onto the whole viewport, for
+  // rendering parts of the world offscreen
+  void UpdateRegionCamera(const glm::vec4& region);
+
+  // Command lists let worker threads record draw packets in parallel.
+  // PrepareCommandLists empties the first count lists; DrawQueue appends them
+  // in index order to the render queue, sorts everything and draws it through
+  // the sprite batch with the currently bound camera space
+  void PrepareCommandLists(size_t count);
+  RenderQueue* GetCommandList(size_t index) { return m_CommandLists[index]; }
+  void DrawQueue();
+  // During the next DrawQueue, draws a premultiplied-alpha image over the
+  // world rect (minX, minY, maxX, maxY) in layer's slot of the draw order,
+  // e.g. a cached render of a static layer
+  void SetLayerImage(RenderLayer layer, GLuint texture, const glm::vec4& rect);
+
+  Shader* GetSpriteShader(ShaderVariant variant) { return m_SpriteShaders[(int)variant]; }
+  Shader* GetBatchShader(ShaderVariant variant) { return m_BatchShaders[(int)variant]; }
   GLuint GetVAO() const { return m_VAO; }
   GLuint GetVBO() const { return m_VBO; }
   GLuint GetEBO() const { return m_EBO; }
-  GLuint GetCircleVAO() const { return m_CircleVAO; }
-  int GetCircleIndexCount() const { return m_CircleIndexCount; }
+  StreamBuffer* GetVertexStream() { return m_VertexStream; }
+  StreamBuffer* GetIndexStream() { return m_IndexStream; }
+  SpriteBatch* GetSpriteBatch() { return m_SpriteBatch; }
+  RenderQueue* GetRenderQueue() { return m_RenderQueue; }
+  GLStateCache* GetStateCache() { return m_StateCache; }
+  RenderStats* GetStats() { return m_Stats; }
+  LightGrid* GetLightGrid() { return m_LightGrid; }
+  AnimationClips* GetAnimationClips() { return m_AnimationClips; }
+#ifdef LEO_DEBUG_DRAW
+  DebugDraw* GetDebugDraw() { return m_DebugDraw; }
+#endif
 
 private:
-  GLuint m_ShaderProgram;
+  static constexpr int kMaxInstances = 16384;
+  static constexpr GLuint kCameraBlockBinding = 0;
+  // View, projection, lighting, then the animation clock
+  static constexpr GLintptr kClockOffset = 2 * sizeof(glm::mat4) + sizeof(LightingBlock);
+  static constexpr GLsizeiptr kCameraBlockSize = kClockOffset + sizeof(glm::vec4);
+  static constexpr size_t kVertexStreamRegionSize = 4 * 1024 * 1024;
+  static constexpr size_t kIndexStreamRegionSize = 1024 * 1024;
+
+  GLStateCache* m_StateCache;
+  RenderStats* m_Stats;
+  Shader* m_SpriteShaders[2];
+  Shader* m_BatchShaders[2];
+  GLuint m_CameraUBO;
+  GLintptr m_CameraBlockStride;
   GLuint m_VAO, m_VBO, m_EBO;
-  GLuint m_CircleVAO, m_CircleVBO, m_CircleEBO;
-  int m_CircleIndexCount;
+  StreamBuffer* m_VertexStream;
+  StreamBuffer* m_IndexStream;
+  SpriteBatch* m_SpriteBatch;
+  RenderQueue* m_RenderQueue;
+  LightGrid* m_LightGrid;
+  AnimationClips* m_AnimationClips;
+  std::vector<RenderQueue*> m_CommandLists;
+  size_t m_ActiveCommandLists;
+
+  struct LayerImage {
+    GLuint texture;  // 0 when the layer has none this frame
+    glm::vec4 rect;
+  };
+  LayerImage m_LayerImages[kRenderLayerCount];
+#ifdef LEO_DEBUG_DRAW
+  DebugDraw* m_DebugDraw;
+#endif
 
   bool CompileShaders();
+  bool LoadShaderVariants(const char* vertexName, const char* vertexFallback,
+                          const char* fragmentFallback, Shader* variants[2]);
   void CreateQuadBuffers();
-  void CreateCircleBuffers();
+  bool CreateStreamBuffers();
+  void CreateCameraBuffer();
+  void DrawLayerImage(RenderLayer layer);
 };
 
 #endif // RENDERER_H
@@ -1,39 +1,90 @@
 #ifndef RESOURCEMANAGER_H
 #define RESOURCEMANAGER_H
 
+#include "AssetPack.h"
+#include "AssetTable.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
 #include "TextRenderer.h"
+#include "TextureStreamer.h"
+#include "ThreadPool.h"
 #include <SDL_mixer.h>
 #include <string>
-#include <map>
+#include <vector>
+
+using SoundHandle = AssetHandle<Mix_Chunk>;
+using MusicHandle = AssetHandle<Mix_Music>;
 
 class ResourceManager {
 public:
   ResourceManager();
   ~ResourceManager();
 
-  bool LoadTexture(const std::string& name, const std::string& path);
-  Texture* GetTexture(const std::string& name);
+  // Maps a cooked asset pack (see AssetPack.h). Loads then take assets from
+  // the pack without decoding, falling back to loose files for anything it
+  // lacks or that was edited since it was cooked. Returns false if there is
+  // no valid pack at path
+  bool OpenPack(const std::string& path);
+
+  // Assets are named by AssetId: pass string literals ("player"), which
+  // hash at compile time, or AssetId::FromString. Loading a name again
+  // replaces the previous asset, and handles to the name resolve to the new
+  // one. Hold handles rather than pointers: they stay cheap to resolve on hot
+  // paths and resolve to nullptr once Cleanup ran.
+
+  // Textures are packed into shared atlas pages; GetTexture returns a
+  // Texture whose ID is the page and whose MapUV gives the sub-rect
+  bool LoadTexture(AssetId name, const std::string& path);
+  // Packs each frameWidth x frameHeight cell separately so animation
+  // frames never bleed into their neighbours
+  bool LoadSpriteSheet(AssetId name, const std::string& path,
+                       int frameWidth, int frameHeight);
+  Texture* GetTexture(AssetId name) const { return m_Textures.Get(name); }
+  Texture* GetTexture(TextureHandle handle) const { return m_Textures.Get(handle); }
+  TextureHandle GetTextureHandle(AssetId name) const { return m_Textures.Find(name); }
+  // Returns at once with a texture showing the checkerboard fallback; the
+  // image decodes on pool and the texture switches to it once
+  // UpdateTextureUploads has uploaded it. Streamed textures are not atlased
+  TextureHandle LoadTextureAsync(AssetId name, const std::string& path, ThreadPool* pool);
+  // Call once per frame on the GL thread; spends up to budgetMs uploading.
+  // Returns how many textures switched to their image
+  int UpdateTextureUploads(double budgetMs);
+  bool IsStreamingTextures() const { return m_Streamer->IsBusy(); }
+  size_t GetStreamingTextureCount() const { return m_Streamer->GetPendingCount(); }
   
-  bool LoadSound(const std::string& name, const std::string& path);
-  Mix_Chunk* GetSound(const std::string& name);
+  // Takes ownership of a texture created elsewhere, e.g. wrapping a
+  // SoftwareRasterizer texture
+  TextureHandle AddTexture(AssetId name, Texture* texture);
+
+  bool LoadSound(AssetId name, const std::string& path);
+  Mix_Chunk* GetSound(AssetId name) const { return m_Sounds.Get(name); }
+  SoundHandle GetSoundHandle(AssetId name) const { return m_Sounds.Find(name); }
   
-  bool LoadMusic(const std::string& name, const std::string& path);
-  Mix_Music* GetMusic(const std::string& name);
+  bool LoadMusic(AssetId name, const std::string& path);
+  Mix_Music* GetMusic(AssetId name) const { return m_Music.Get(name); }
   
   bool LoadFont(const std::string& path, int fontSize);
   TextRenderer* GetTextRenderer() { return m_TextRenderer; }
   
-  void PlayMusic(const std::string& name, int loops = -1);
-  void PlaySound(const std::string& name);
+  void PlayMusic(AssetId name, int loops = -1);
+  void PlaySound(AssetId name) { PlaySound(m_Sounds.Get(name)); }
+  void PlaySound(SoundHandle handle) { PlaySound(m_Sounds.Get(handle)); }
   
   void Cleanup();
 
 private:
-  std::map<std::string, Texture*> m_Textures;
-  std::map<std::string, Mix_Chunk*> m_Sounds;
-  std::map<std::string, Mix_Music*> m_Music;
+  AssetPack* m_Pack;  // outlives everything loaded from it
+  AssetTable<Texture> m_Textures;
+  // Replaced textures; the streamer may still be uploading into them
+  std::vector<Texture*> m_RetiredTextures;
+  TextureAtlas* m_Atlas;
+  TextureStreamer* m_Streamer;
+  AssetTable<Mix_Chunk> m_Sounds;
+  AssetTable<Mix_Music> m_Music;
   TextRenderer* m_TextRenderer;
+
+  const AssetPackEntry* FindInPack(const std::string& path, AssetType type) const;
+  void PlaySound(Mix_Chunk* sound);
 };
 
 #endif // RESOURCEMANAGER_H
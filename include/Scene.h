@@ -3,6 +3,8 @@
 
 #include "GameObject.h"
 #include "CollisionManager.h"
+#include "SpatialGrid.h"
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -18,10 +20,40 @@ public:
   void UpdatePlayerMovement(glm::vec2 movement, float speed, float deltaTime, bool& wasColliding);
   void CheckCollisions(GameObject* player, bool& isColliding);
 
+  // Re-files an object in the spatial index; call after moving it
+  void OnObjectMoved(size_t index);
+  // Returns the indices of objects overlapping viewRect (minX, minY, maxX,
+  // maxY) in scene order. Valid until the next call.
+  const std::vector<uint32_t>& Cull(const glm::vec4& viewRect);
+  size_t GetVisibleCount() const { return m_VisibleIndices.size(); }
+  size_t GetCulledCount() const { return m_GameObjects.size() - m_VisibleIndices.size(); }
+  const SpatialGrid& GetGrid() const { return m_Grid; }
+
+  // Objects on a static layer are drawn from a cached image instead of every
+  // frame, so they must not animate. Adding or moving an object bumps its
+  // layer's revision; call InvalidateLayer after any other visible change.
+  void SetLayerStatic(RenderLayer layer, bool isStatic) { m_LayerStatic[(int)layer] = isStatic; }
+  bool IsLayerStatic(RenderLayer layer) const { return m_LayerStatic[(int)layer]; }
+  void InvalidateLayer(RenderLayer layer) {
+    m_LayerRevisions[(int)layer]++;
+    m_Revision++;
+  }
+  uint32_t GetLayerRevision(RenderLayer layer) const { return m_LayerRevisions[(int)layer]; }
+  // Bumped with any layer's revision; unchanged means the scene looks the
+  // same as when it was last read
+  uint32_t GetRevision() const { return m_Revision; }
+
   void Cleanup();
 
 private:
   std::vector<GameObject*> m_GameObjects;
+  SpatialGrid m_Grid;
+  std::vector<uint32_t> m_VisibleIndices;
+  bool m_LayerStatic[kRenderLayerCount];
+  uint32_t m_LayerRevisions[kRenderLayerCount];
+  uint32_t m_Revision;
+
+  static glm::vec4 GetBounds(const GameObject& obj);
 };
 
 #endif // SCENE_H
@@ -0,0 +1,43 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include "GLStateCache.h"
+#include <GL/glew.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Linked GLSL program with its active uniform locations resolved once at
+// link time. Defines are injected after the #version line so one source
+// can produce several compile-time variants.
+class Shader {
+public:
+  Shader();
+  ~Shader();
+
+  bool Compile(const std::string& vertexSource, const std::string& fragmentSource,
+               const std::vector<std::string>& defines = {});
+  bool LoadFromFiles(const std::string& vertexPath, const std::string& fragmentPath,
+                     const std::vector<std::string>& defines = {});
+  void Cleanup();
+
+  void Use() const { GLStateCache::Get()->UseProgram(m_ID); }
+  GLuint GetID() const { return m_ID; }
+
+  // Cached lookup, returns -1 for uniforms the linker optimized away
+  GLint GetUniformLocation(const std::string& name) const;
+  void BindUniformBlock(const char* blockName, GLuint bindingPoint);
+
+  static bool ReadFile(const std::string& path, std::string& contents);
+
+private:
+  GLuint m_ID;
+  std::unordered_map<std::string, GLint> m_UniformLocations;
+
+  static GLuint CompileStage(GLenum type, const std::string& source);
+  static std::string InjectDefines(const std::string& source,
+                                   const std::vector<std::string>& defines);
+  void CacheUniformLocations();
+};
+
+#endif // SHADER_H
@@ -0,0 +1,87 @@
+#ifndef SOFTWARERASTERIZER_H
+#define SOFTWARERASTERIZER_H
+
+#include "AnimationClips.h"
+#include "RenderBackend.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// CPU render backend for headless rendering (thumbnails, replay checks on
+// machines without a GPU). Draws the same sprites as SpriteBatch into an
+// RGBA8 buffer, following GL's rules where they decide pixels: pixel
+// centers inside the quad are covered, textures are sampled nearest with
+// repeat, and SRC_ALPHA / ONE_MINUS_SRC_ALPHA blending applies to all four
+// channels. Output matches the GL path to within rounding, except for
+// lighting, which this backend does not do.
+//
+// Submitted quads are recorded, then End bins them into kTileSize tiles and
+// rasterizes the tiles in parallel, each in submission order. Spans are
+// blended four pixels at a time with SSE2.
+class SoftwareRasterizer : public RenderBackend {
+public:
+  static constexpr int kTileSize = 64;
+
+  SoftwareRasterizer();
+  ~SoftwareRasterizer() override;
+
+  // pool may be null to rasterize on the calling thread
+  bool Init(int width, int height, ThreadPool* pool = nullptr);
+
+  // rgba rows start at the top. Returns the id to submit the texture with
+  GLuint AddTexture(int width, int height, const uint8_t* rgba);
+  // Decodes an image file; 0 if it cannot be read
+  GLuint LoadTexture(const char* path, int* width = nullptr, int* height = nullptr);
+  // Resolves SpriteBatch::AnimationParams, as SpriteBatch's vertex path does
+  void SetAnimationClips(const AnimationClips* clips) { m_AnimationClips = clips; }
+
+  // World rect (minX, minY, maxX, maxY) mapped onto the whole target, top
+  // row first, like the GL world camera. Defaults to pixel coordinates
+  void SetView(const glm::vec4& viewRect);
+  void Clear(glm::vec4 color);
+
+  void Begin() override;
+  void End() override;
+  void SubmitQuad(GLuint texture, glm::vec2 position, glm::vec2 size,
+                  glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                  glm::vec4 color = glm::vec4(1.0f)) override;
+
+  int GetWidth() const { return m_Width; }
+  int GetHeight() const { return m_Height; }
+  // One RGBA8 pixel per element, red in the lowest byte, top row first
+  const std::vector<uint32_t>& GetPixels() const { return m_Pixels; }
+  bool SavePNG(const char* path) const;
+
+private:
+  struct SoftTexture {
+    int width, height;
+    std::vector<uint32_t> texels;
+  };
+
+  // A quad in target pixels
+  struct Command {
+    glm::vec2 min, max;     // Quad edges
+    int x0, y0, x1, y1;     // Covered pixel centers, max exclusive
+    uint32_t texture;       // Index into m_Textures + 1, 0 for solid
+    glm::vec4 uv;           // u at min.x (x), v at min.y (y), u at max.x (z), v at max.y (w)
+    uint32_t color;         // RGBA8
+    glm::vec4 shape;        // Half size in pixels (xy), kind (z), parameter in pixels (w)
+  };
+
+  int m_Width, m_Height;
+  ThreadPool* m_Pool;
+  const AnimationClips* m_AnimationClips;
+  glm::vec2 m_ViewOrigin;
+  glm::vec2 m_ViewScale;
+  std::vector<uint32_t> m_Pixels;
+  std::vector<SoftTexture> m_Textures;
+  std::vector<Command> m_Commands;
+  int m_TileColumns, m_TileRows;
+  std::vector<std::vector<uint32_t>> m_TileCommands;  // Command indices per tile
+
+  void RasterizeTile(int tile);
+  void DrawCommand(const Command& command, int x0, int y0, int x1, int y1);
+  void DrawShapeSpan(const Command& command, int y, int x0, int x1, uint32_t* source);
+};
+
+#endif // SOFTWARERASTERIZER_H
@@ -0,0 +1,45 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform hash grid over world space. Ids are small dense integers (scene
+// indices); bounds are (minX, minY, maxX, maxY).
+class SpatialGrid {
+public:
+  explicit SpatialGrid(float cellSize = 256.0f);
+
+  void Insert(uint32_t id, const glm::vec4& bounds);
+  void Update(uint32_t id, const glm::vec4& bounds);
+  void Remove(uint32_t id);
+  void Clear();
+
+  // Appends every id whose bounds overlap rect, each id once, unordered
+  void Query(const glm::vec4& rect, std::vector<uint32_t>& results);
+
+  float GetCellSize() const { return m_CellSize; }
+
+private:
+  struct Entry {
+    bool present;
+    glm::vec4 bounds;
+    glm::ivec2 minCell;
+    glm::ivec2 maxCell;
+  };
+
+  float m_CellSize;
+  std::unordered_map<uint64_t, std::vector<uint32_t>> m_Cells;
+  std::vector<Entry> m_Entries;
+  std::vector<uint32_t> m_QueryStamps;
+  uint32_t m_CurrentStamp;
+
+  glm::ivec2 CellOf(float x, float y) const;
+  static uint64_t CellKey(int x, int y);
+  void AddToCells(uint32_t id, glm::ivec2 minCell, glm::ivec2 maxCell);
+  void RemoveFromCells(uint32_t id, glm::ivec2 minCell, glm::ivec2 maxCell);
+};
+
+#endif // SPATIALGRID_H
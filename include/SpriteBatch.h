@@ -0,0 +1,147 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include "AnimationClips.h"
+#include "RenderBackend.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Solid shapes are drawn as quads and cut out in the fragment shader from a
+// signed distance, so every shape shares runs and instances with plain quads.
+// Values are the shape kind the shaders read
+enum class SpriteShape {
+  Quad = 0,
+  Circle = 1,      // ellipse filling the quad
+  Ring = 2,        // parameter is the ring thickness
+  RoundedRect = 3, // parameter is the corner radius
+  Capsule = 4      // rounded rect with fully round short ends
+};
+
+enum class SpriteBatchMode {
+  Vertices,  // CPU-transformed vertices in one dynamic VBO
+  Instanced  // One instance record per sprite, glDrawElementsInstanced
+};
+
+struct SpriteVertex {
+  glm::vec2 position;
+  glm::vec2 texCoord;  // offset from the quad center for solid sprites
+  glm::vec4 color;
+  glm::vec4 shape;     // half size (x, y), kind (z), parameter (w)
+};
+
+// Per-instance attributes read by Renderer's sprite shader (locations 2-4)
+struct SpriteInstance {
+  glm::vec4 positionSize;       // center (x, y), size (z, w)
+  glm::vec4 textureOffsetScale; // shape parameters for solid sprites
+  glm::vec4 color;
+};
+
+// OpenGL render backend. Collects sprites and draws them with one draw call
+// per texture run instead of one draw per GameObject. Texture 0 means a
+// solid colored shape and draws with the Solid shader variant; its uvRect
+// then holds ShapeParams instead of a texture rect. View/projection come from the
+// Renderer's camera uniform block. Vertices, indices and instances are
+// written straight into the Renderer's stream buffers, no CPU-side copy.
+class SpriteBatch : public RenderBackend {
+public:
+  SpriteBatch();
+  ~SpriteBatch() override;
+
+  bool Init(Shader* texturedShader, Shader* solidShader, StreamBuffer* vertexStream,
+            StreamBuffer* indexStream, int maxVertices = 65536);
+  // Instanced mode draws the Renderer's static quad VAO, whose per-instance
+  // attributes source from the vertex stream
+  void InitInstancing(Shader* texturedShader, Shader* solidShader,
+                      GLuint quadVAO, int quadIndexCount, int maxInstances);
+  void Cleanup();
+
+  void SetMode(SpriteBatchMode mode) { m_Mode = mode; }
+  SpriteBatchMode GetMode() const { return m_Mode; }
+
+  void Begin() override;
+  void End() override;
+
+  // uvRect is (x, y, width, height) in normalized texture coordinates,
+  // the same layout Animation::GetCurrentFrameCoords returns
+  void SubmitQuad(GLuint texture, glm::vec2 position, glm::vec2 size,
+                  glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                  glm::vec4 color = glm::vec4(1.0f)) override;
+  // Solid shape filling the size x size quad centered on position
+  void SubmitShape(SpriteShape shape, glm::vec2 position, glm::vec2 size, glm::vec4 color,
+                   float parameter = 0.0f);
+
+  // uvRect/textureOffsetScale of a solid sprite: kind (x), parameter (y)
+  static glm::vec4 ShapeParams(SpriteShape shape, float parameter = 0.0f) {
+    return glm::vec4((float)shape, parameter, 0.0f, 0.0f);
+  }
+  // uvRect/textureOffsetScale of a textured sprite playing an AnimationClips
+  // clip: clip id (x), start time (y). The zero size marks it
+  static glm::vec4 AnimationParams(int clip, float startTime) {
+    return glm::vec4((float)clip, startTime, 0.0f, 0.0f);
+  }
+  static bool IsAnimationParams(const glm::vec4& uvRect) {
+    return uvRect.z == 0.0f && uvRect.w == 0.0f;
+  }
+  // Instanced sprites evaluate clips in the vertex shader; the vertex path
+  // resolves them here on the CPU
+  void SetAnimationClips(const AnimationClips* clips) { m_AnimationClips = clips; }
+
+  // Counters accumulate over all Begin/End pairs since ResetCounters
+  void ResetCounters();
+  int GetDrawCallCount() const { return m_DrawCalls; }
+  int GetSpriteCount() const { return m_Sprites; }
+
+  // Points instance attributes 2-4 of the bound VAO at SpriteInstance
+  // records starting at offset in the bound GL_ARRAY_BUFFER
+  static void SetInstanceAttributes(GLintptr offset);
+
+  // Draws count SpriteInstance records that the caller wrote into the
+  // vertex stream at offset, outside of Begin/End. For systems that fill
+  // their own instance data, such as particle emitters
+  void DrawInstances(GLuint texture, GLintptr offset, int count);
+
+private:
+  SpriteBatchMode m_Mode;
+  Shader* m_TexturedShader;
+  Shader* m_SolidShader;
+  GLuint m_VAO;
+  StreamBuffer* m_VertexStream;
+  StreamBuffer* m_IndexStream;
+  int m_MaxVertices;
+  int m_MaxIndices;
+
+  // Current run, mapped from the stream buffers (nullptr when none is open).
+  // A run maps what is left of the streams' regions, up to the maximum, and
+  // only its written part is committed
+  SpriteVertex* m_Vertices;
+  unsigned int* m_Indices;
+  GLintptr m_VertexOffset, m_IndexOffset;
+  int m_VertexCount, m_IndexCount;
+  int m_VertexCapacity, m_IndexCapacity;
+  GLuint m_CurrentTexture;
+  const AnimationClips* m_AnimationClips;
+
+  // Instanced mode
+  Shader* m_InstancedTexturedShader;
+  Shader* m_InstancedSolidShader;
+  GLuint m_QuadVAO;
+  int m_QuadIndexCount;
+  int m_MaxInstances;
+  SpriteInstance* m_Instances;
+  GLintptr m_InstanceOffset;
+  int m_InstanceCount;
+  int m_InstanceCapacity;
+
+  int m_DrawCalls;
+  int m_Sprites;
+
+  bool Reserve(GLuint texture, int vertexCount, int indexCount);
+  bool ReserveInstance(GLuint texture);
+  void Flush();
+  void FlushVertices();
+  void FlushInstances();
+};
+
+#endif // SPRITEBATCH_H
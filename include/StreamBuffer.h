@@ -0,0 +1,64 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <GL/glew.h>
+#include <cstddef>
+
+// Ring buffer for data written by the CPU every frame (sprite vertices,
+// instances, indices). With ARB_buffer_storage the whole buffer stays
+// persistently and coherently mapped and is split into regions; a fence is
+// placed when writing leaves a region and waited on before it is reused, so
+// the CPU never writes memory the GPU may still read. Without it the buffer
+// is orphaned on wrap and written through unsynchronized glMapBufferRange.
+//
+// Usage: Map up to maxBytes, write sequentially (never read back), Commit the
+// bytes actually written, then draw from GetID() at the returned offset.
+// Only committed bytes use up a region, so callers that don't know their
+// size up front should map with a small minBytes and take what is left of
+// the region rather than reserving the worst case.
+class StreamBuffer {
+public:
+  StreamBuffer();
+  ~StreamBuffer();
+
+  bool Init(size_t regionSize, int regionCount = 3);
+  void Cleanup();
+
+  // Returns a write pointer for up to maxBytes starting at offset (a multiple
+  // of alignment), or nullptr if maxBytes exceeds a region
+  void* Map(size_t maxBytes, size_t alignment, GLintptr& offset) {
+    size_t mappedBytes;
+    return Map(maxBytes, maxBytes, alignment, offset, mappedBytes);
+  }
+  // Maps at least minBytes and as much of maxBytes as the current region
+  // still holds; mappedBytes receives the writable size. Moves on to the
+  // next region only when minBytes does not fit
+  void* Map(size_t minBytes, size_t maxBytes, size_t alignment, GLintptr& offset,
+            size_t& mappedBytes);
+  void Commit(size_t usedBytes);
+
+  GLuint GetID() const { return m_ID; }
+  bool IsPersistent() const { return m_Persistent; }
+
+private:
+  static constexpr int kMaxRegions = 4;
+
+  GLuint m_ID;
+  bool m_Persistent;
+  unsigned char* m_Mapping;  // persistent path only
+  size_t m_RegionSize;
+  int m_RegionCount;
+  size_t m_Size;
+  int m_Region;              // region being written, persistent path only
+  size_t m_Head;
+  size_t m_Pending;          // offset of the current Map, or SIZE_MAX
+  GLsync m_Fences[kMaxRegions];
+
+  void* MapPersistent(size_t minBytes, size_t maxBytes, size_t alignment, GLintptr& offset,
+                      size_t& mappedBytes);
+  void* MapOrphaned(size_t minBytes, size_t maxBytes, size_t alignment, GLintptr& offset,
+                    size_t& mappedBytes);
+  void WaitForRegion(int region);
+};
+
+#endif // STREAMBUFFER_H
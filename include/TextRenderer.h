@@ -1,31 +1,58 @@
 #ifndef TEXTRENDERER_H
 #define TEXTRENDERER_H
 
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 
+// Draws text from a glyph atlas: every Latin-1 glyph is rasterized once per
+// font/size, and strings are laid out as quads in the caller's SpriteBatch,
+// so changing text only changes vertices.
 class TextRenderer {
 public:
   TextRenderer();
   ~TextRenderer();
 
   bool LoadFont(const char* fontPath, int fontSize);
-  void RenderText(const std::string& text, int x, int y, 
-                  GLuint shaderProgram, GLuint VAO, 
-                  int screenWidth, int screenHeight);
+  // Font file contents in memory, which must stay valid until Cleanup;
+  // name is only for the log
+  bool LoadFontMemory(const void* data, size_t size, int fontSize, const char* name);
+  // Submits the text centered at (x, y) into a batch using the screen space
+  // camera block
+  void RenderText(const std::string& text, int x, int y, SpriteBatch& batch,
+                  glm::vec4 color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+  glm::vec2 MeasureText(const std::string& text);
   void Cleanup();
 
 private:
+  struct Glyph {
+    bool cached;
+    GLuint page;
+    glm::vec4 uvRect;
+    int width, height; // rendered glyph cell, one line high
+    int advance;
+  };
+
+  static constexpr int kFirstPrecached = 32;
+  static constexpr int kLastPrecached = 126;
+  static constexpr int kPrecachedCount = kLastPrecached - kFirstPrecached + 1;
+
   TTF_Font* m_Font;
-  GLuint m_TextTexture;
-  int m_TextWidth;
-  int m_TextHeight;
-  
-  void CreateTextTexture(const std::string& text);
+  TextureAtlas* m_Atlas;
+  int m_LineHeight;
+  std::vector<Glyph> m_Glyphs;   // indexed by Latin-1 code
+  std::vector<short> m_Kerning;  // printable ASCII pairs
+
+  bool InitFont(const char* name);
+  const Glyph& GetGlyph(unsigned char code);
+  bool RasterizeGlyphs(const std::vector<unsigned char>& codes);
+  int GetKerning(unsigned char previous, unsigned char code) const;
+  void BuildKerningTable();
 };
 
 #endif // TEXTRENDERER_H
-
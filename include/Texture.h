@@ -1,7 +1,12 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include "AssetTable.h"
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class TextureAtlas;
 
 class Texture {
 public:
@@ -9,16 +14,50 @@ public:
   ~Texture();
 
   bool Load(const char *path);
+  // Packs the image into an atlas page instead of creating its own texture.
+  // With a cell size, each sprite sheet cell is packed (and padded) separately.
+  bool LoadIntoAtlas(const char *path, TextureAtlas& atlas,
+                     int cellWidth = 0, int cellHeight = 0);
+  // Same from already decoded RGBA8 pixels (e.g. a mapped AssetPack entry)
+  // followed by levels - 1 smaller mip levels; name is only for the log
+  bool LoadIntoAtlas(const unsigned char *rgba, int imageWidth, int imageHeight, int levels,
+                     const char *name, TextureAtlas& atlas,
+                     int cellWidth = 0, int cellHeight = 0);
+  // Standalone texture from RGBA8 pixels and their mip chain
+  bool LoadPixels(const unsigned char *rgba, int imageWidth, int imageHeight, int levels,
+                  const char *name);
+  // Refers to a texture name owned elsewhere (e.g. a SoftwareRasterizer id);
+  // Cleanup leaves it alone
+  void Wrap(GLuint id, int textureWidth, int textureHeight);
+  // Takes ownership of a standalone GL texture, replacing the current one
+  void Adopt(GLuint id, int textureWidth, int textureHeight);
+
+  // Size of the checkerboard shown for images that failed or are not loaded yet
+  static constexpr int kFallbackSize = 64;
+  // Fills the texture bound to GL_TEXTURE_2D with the checkerboard
+  static void UploadFallback();
   void Bind();
   void Unbind();
   void Cleanup();
   
   int GetWidth() const { return width; }
   int GetHeight() const { return height; }
+  GLuint GetID() const { return ID; }
+
+  // Maps a (x, y, width, height) rect in this texture's own normalized
+  // coordinates to the GL texture it lives in (the atlas page, if packed)
+  glm::vec4 MapUV(const glm::vec4& rect) const;
 
 private:
   GLuint ID;
   int width, height, nrChannels;
+  bool ownsID;
+  glm::vec4 uvRect;               // region of the GL texture
+  int cellColumns, cellRows;
+  std::vector<glm::vec4> cellRects; // per-cell regions for packed sheets
 };
 
+// A Texture held by ResourceManager, resolved with GetTexture
+using TextureHandle = AssetHandle<Texture>;
+
 #endif // TEXTURE_H
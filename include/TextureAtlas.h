@@ -0,0 +1,58 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+// RGBA8 image (or sub-image of a larger one) to be packed
+struct AtlasImage {
+  const unsigned char* pixels; // first pixel of the image
+  int width;
+  int height;
+  int stride;                  // bytes per source row
+};
+
+// Packs images into large RGBA pages with a skyline bottom-left packer so
+// sprites from different files share one GL texture and can be batched.
+// Each image is surrounded by `padding` pixels of its own extruded edge
+// so filtering never samples a neighbour.
+class TextureAtlas {
+public:
+  TextureAtlas(int pageSize = 2048, int padding = 2);
+  ~TextureAtlas();
+
+  // Packs all images onto the same page. uvRects receives one
+  // (x, y, width, height) rect per image in normalized page coordinates.
+  // Returns false if the group cannot fit on a single page.
+  bool Add(const std::vector<AtlasImage>& images, GLuint& pageID,
+           std::vector<glm::vec4>& uvRects);
+  void Cleanup();
+
+  int GetPageCount() const { return (int)m_Pages.size(); }
+  int GetPageSize() const { return m_PageSize; }
+
+private:
+  struct SkylineNode {
+    int x, y, width;
+  };
+
+  struct Page {
+    GLuint ID;
+    std::vector<SkylineNode> skyline;
+  };
+
+  int m_PageSize;
+  int m_Padding;
+  std::vector<Page> m_Pages;
+
+  bool PackGroup(std::vector<SkylineNode>& skyline, const std::vector<AtlasImage>& images,
+                 std::vector<glm::ivec2>& positions) const;
+  bool Insert(std::vector<SkylineNode>& skyline, int width, int height,
+              glm::ivec2& position) const;
+  int Fit(const std::vector<SkylineNode>& skyline, size_t index, int width, int height) const;
+  void Upload(GLuint pageID, const AtlasImage& image, glm::ivec2 position) const;
+  GLuint CreatePage() const;
+};
+
+#endif // TEXTUREATLAS_H
@@ -0,0 +1,86 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include "Texture.h"
+#include "ThreadPool.h"
+#include <GL/glew.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+// Loads textures without stalling the GL thread. Request points the texture
+// at a shared checkerboard right away and decodes the file on a worker;
+// Update then uploads decoded images through a pixel unpack buffer in row
+// strips, stopping once the frame's time budget is spent, and swaps each
+// finished texture in. A large image may take several frames, but no frame
+// waits on a decode or a whole upload.
+//
+// Streamed textures are standalone GL textures, not atlas pages: packing
+// would copy through the atlas' own synchronous upload.
+class TextureStreamer {
+public:
+  TextureStreamer();
+  ~TextureStreamer();
+
+  // Waits for decodes still running on workers, then frees everything,
+  // including textures only partly uploaded
+  void Cleanup();
+
+  // texture must outlive Cleanup. Decodes run as pool background work, behind
+  // any frame tasks; pool may be null to decode on the calling thread (the
+  // upload still waits for Update)
+  void Request(Texture* texture, const std::string& path, ThreadPool* pool);
+  // Already decoded RGBA8 pixels that stay valid until uploaded (e.g. a
+  // mapped AssetPack entry); only the upload is deferred
+  void RequestPixels(Texture* texture, const unsigned char* rgba, int width, int height,
+                     const std::string& name);
+
+  // Uploads on the GL thread for up to budgetMs (at least one strip).
+  // Returns how many textures were swapped in
+  int Update(double budgetMs);
+
+  // Decodes or uploads still outstanding
+  bool IsBusy() const;
+  size_t GetPendingCount() const;
+
+private:
+  // Bytes copied per strip; small enough to keep the budget check fine
+  // grained, large enough that per-strip GL calls don't dominate
+  static constexpr size_t kStripBytes = 256 * 1024;
+
+  struct Decoded {
+    Texture* texture;
+    std::string path;
+    const unsigned char* pixels;  // RGBA8, null if decoding failed
+    int width, height;
+    bool ownsPixels;              // from stbi_load, freed after upload
+  };
+
+  // Texture being uploaded strip by strip
+  struct Upload {
+    Decoded image;
+    GLuint id;
+    int nextRow;
+  };
+
+  GLuint m_FallbackID;
+  GLuint m_UnpackBuffer;
+  Upload m_Current;
+  bool m_Uploading;
+
+  mutable std::mutex m_Mutex;
+  std::condition_variable m_DecodeFinished;
+  std::deque<Decoded> m_Decoded;
+  int m_Decoding;  // requests not yet in m_Decoded
+
+  void Decode(Texture* texture, const std::string& path);
+  void ShowFallback(Texture* texture);
+  static void FreePixels(Decoded& image);
+  bool StartUpload();
+  void UploadStrip();
+  void FinishUpload();
+};
+
+#endif // TEXTURESTREAMER_H
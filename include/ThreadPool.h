@@ -0,0 +1,48 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from two task queues: frame work, and
+// background work (asset decodes) that workers only pick up while no frame
+// work is waiting. Workers never touch GL; only the thread owning the
+// context may.
+class ThreadPool {
+public:
+  // 0 picks one worker per hardware thread, minus the calling thread
+  explicit ThreadPool(int threadCount = 0);
+  ~ThreadPool();
+
+  int GetThreadCount() const { return (int)m_Workers.size(); }
+
+  void Submit(std::function<void()> task);
+  // Long-running work that must not delay frame tasks
+  void SubmitBackground(std::function<void()> task);
+
+  // Splits [0, count) into chunkCount contiguous ranges and runs
+  // body(chunk, begin, end) for each, on idle workers and the calling
+  // thread. The caller only ever runs chunks of this call, so queued
+  // background work cannot hold it up. Returns once every chunk has
+  // finished.
+  void ParallelFor(size_t count, size_t chunkCount,
+                   const std::function<void(size_t, size_t, size_t)>& body);
+
+private:
+  std::vector<std::thread> m_Workers;
+  std::deque<std::function<void()>> m_Tasks;
+  std::deque<std::function<void()>> m_BackgroundTasks;
+  std::mutex m_Mutex;
+  std::condition_variable m_TaskReady;
+  bool m_Stopping;
+
+  void WorkerLoop();
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,79 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "Shader.h"
+#include "Texture.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Grid of tiles drawn from one tileset texture. Each layer is split into
+// kChunkSize x kChunkSize chunks whose quads are baked once into a static
+// VBO and rebuilt only after one of their tiles changes; Draw only touches
+// chunks overlapping the view. Tile 0 is empty, tile n is tileset cell n - 1
+// counting left to right, top to bottom.
+class Tilemap {
+public:
+  static constexpr int kChunkSize = 32;
+
+  // origin is the world position of the top-left corner of tile (0, 0)
+  Tilemap(int width, int height, float tileSize, glm::vec2 origin = glm::vec2(0.0f));
+  ~Tilemap();
+
+  // shader is the textured batch shader (position, uv, color at 0-2)
+  bool Init(Texture* tileset, int tilePixelWidth, int tilePixelHeight, Shader* shader);
+  void Cleanup();
+
+  // Layers draw in the order they were added
+  int AddLayer();
+  void SetTile(int layer, int x, int y, uint16_t tile);
+  uint16_t GetTile(int layer, int x, int y) const;
+
+  // Draws every layer's chunks that overlap viewRect (minX, minY, maxX, maxY)
+  // with the currently bound camera space
+  void Draw(const glm::vec4& viewRect);
+
+  int GetWidth() const { return m_Width; }
+  int GetHeight() const { return m_Height; }
+  // Counters of the last Draw
+  int GetDrawnChunkCount() const { return m_DrawnChunks; }
+  int GetRebuiltChunkCount() const { return m_RebuiltChunks; }
+
+private:
+  // Color comes from a constant attribute, so tiles only store these
+  struct TileVertex {
+    glm::vec2 position;
+    glm::vec2 texCoord;
+  };
+
+  struct Chunk {
+    GLuint VAO, VBO;
+    int quadCount;
+    bool dirty;
+  };
+
+  struct Layer {
+    std::vector<uint16_t> tiles;
+    std::vector<Chunk> chunks;
+  };
+
+  int m_Width, m_Height;
+  float m_TileSize;
+  glm::vec2 m_Origin;
+  int m_ChunkColumns, m_ChunkRows;
+
+  Texture* m_Tileset;
+  Shader* m_Shader;
+  int m_TilesetColumns, m_TilesetRows;
+  std::vector<glm::vec4> m_TileUVs;  // per tileset cell, resolved into the atlas
+  GLuint m_EBO;                      // quad indices shared by every chunk
+
+  std::vector<Layer> m_Layers;
+  int m_DrawnChunks;
+  int m_RebuiltChunks;
+
+  void BuildChunk(Layer& layer, int chunkX, int chunkY);
+};
+
+#endif // TILEMAP_H
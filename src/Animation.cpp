@@ -1,6 +1,7 @@
 #include "Animation.h"
 
-Animation::Animation(Texture* spriteSheet, const std::vector<glm::vec4>& frames, float frameDuration)
+Animation::Animation(TextureHandle spriteSheet, const std::vector<glm::vec4>& frames,
+                     float frameDuration)
     : m_SpriteSheet(spriteSheet), m_Frames(frames), m_FrameDuration(frameDuration),
       m_CurrentFrameIndex(0), m_Timer(0.0f) {
   if (m_Frames.empty()) {
@@ -8,9 +9,7 @@ Animation::Animation(Texture* spriteSheet, const std::vector<glm::vec4>& frames,
   }
 }
 
-Animation::~Animation() {
-  // Don't delete m_SpriteSheet, it's managed elsewhere
-}
+Animation::~Animation() {}
 
 void Animation::Update(float deltaTime) {
   if (m_Frames.empty() || m_FrameDuration <= 0.0f) {
@@ -32,6 +31,13 @@ glm::vec4 Animation::GetCurrentFrameCoords() const {
   return m_Frames[m_CurrentFrameIndex];
 }
 
+float Animation::GetTimeToNextFrame() const {
+  if (m_Frames.size() < 2 || m_FrameDuration <= 0.0f) {
+    return -1.0f;
+  }
+  return m_FrameDuration - m_Timer;
+}
+
 void Animation::Reset() {
   m_CurrentFrameIndex = 0;
   m_Timer = 0.0f;
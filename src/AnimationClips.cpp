@@ -0,0 +1,87 @@
+#include "AnimationClips.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+
+AnimationClips::AnimationClips()
+    : m_Buffer(0), m_Texture(0), m_UploadedTexels(0), m_Time(0.0f) {}
+
+AnimationClips::~AnimationClips() {
+  Cleanup();
+}
+
+bool AnimationClips::Init() {
+  GLStateCache* state = GLStateCache::Get();
+  glGenBuffers(1, &m_Buffer);
+  state->BindBuffer(GL_TEXTURE_BUFFER, m_Buffer);
+  glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), nullptr, GL_STATIC_DRAW);
+
+  // Stays bound to its unit, like the light grid's buffers
+  glGenTextures(1, &m_Texture);
+  state->BindTexture(GL_TEXTURE0 + kTextureUnit, GL_TEXTURE_BUFFER, m_Texture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_Buffer);
+  state->ActiveTexture(GL_TEXTURE0);
+  return true;
+}
+
+void AnimationClips::Cleanup() {
+  if (m_Texture != 0) {
+    GLStateCache* state = GLStateCache::Get();
+    state->DeleteTexture(m_Texture);
+    state->DeleteBuffer(m_Buffer);
+    m_Texture = 0;
+    m_Buffer = 0;
+  }
+  m_Table.clear();
+  m_UploadedTexels = 0;
+}
+
+int AnimationClips::AddClip(const Texture* texture, const std::vector<glm::vec4>& frames,
+                            float frameDuration, AnimationLoop loop) {
+  if (frames.empty() || !texture) {
+    return -1;
+  }
+  int clip = (int)m_Table.size();
+  m_Table.push_back(glm::vec4((float)frames.size(), std::max(frameDuration, 1e-4f),
+                              (float)loop, 0.0f));
+  for (const glm::vec4& frame : frames) {
+    m_Table.push_back(texture->MapUV(frame));
+  }
+  return clip;
+}
+
+glm::vec4 AnimationClips::Evaluate(int clip, float startTime) const {
+  if (clip < 0 || clip >= (int)m_Table.size()) {
+    return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+  }
+  const glm::vec4& header = m_Table[clip];
+  int count = (int)header.x;
+  int frame = (int)(std::max(m_Time - startTime, 0.0f) / header.y);
+  switch ((AnimationLoop)(int)header.z) {
+  case AnimationLoop::Loop:
+    frame %= count;
+    break;
+  case AnimationLoop::Once:
+    frame = std::min(frame, count - 1);
+    break;
+  case AnimationLoop::PingPong: {
+    int period = std::max(2 * count - 2, 1);
+    frame %= period;
+    frame = frame < count ? frame : period - frame;
+    break;
+  }
+  }
+  return m_Table[clip + 1 + frame];
+}
+
+void AnimationClips::Upload() {
+  if (m_Table.size() == m_UploadedTexels || m_Buffer == 0) {
+    return;
+  }
+  size_t bytes = m_Table.size() * sizeof(glm::vec4);
+  GLStateCache::Get()->BindBuffer(GL_TEXTURE_BUFFER, m_Buffer);
+  glBufferData(GL_TEXTURE_BUFFER, bytes, m_Table.data(), GL_STATIC_DRAW);
+  RenderStats::Get()->AddStreamedBytes(bytes);
+  m_UploadedTexels = m_Table.size();
+}
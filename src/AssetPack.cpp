@@ -0,0 +1,169 @@
+#include "AssetPack.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Cooked textures and sounds are read through their info, not just their
+// size, so the two must agree before any loader trusts them
+static bool IsEntryInfoValid(const AssetPackEntry& entry) {
+  switch (entry.type) {
+  case AssetType::Texture: {
+    uint64_t width = entry.info[0], height = entry.info[1];
+    uint32_t levels = entry.info[2];
+    if (width == 0 || height == 0 || width > kMaxAssetTextureSize ||
+        height > kMaxAssetTextureSize || levels == 0 || levels > 32) {
+      return false;
+    }
+    // Levels back to back, each half the previous, rounded down, at least 1
+    uint64_t bytes = 0;
+    for (uint32_t level = 0; level < levels; level++) {
+      bytes += width * height * 4;
+      width = std::max<uint64_t>(width / 2, 1);
+      height = std::max<uint64_t>(height / 2, 1);
+    }
+    return bytes <= entry.size;
+  }
+  case AssetType::Sound: {
+    // SDL audio formats keep the sample size in bits in the low byte
+    uint64_t frameBytes = (uint64_t)(entry.info[1] & 0xFF) / 8 * entry.info[2];
+    return entry.info[0] > 0 && frameBytes > 0 && entry.size % frameBytes == 0;
+  }
+  default:
+    return true;
+  }
+}
+
+AssetPack::AssetPack()
+    : m_Data(nullptr), m_Size(0), m_Entries(nullptr), m_EntryCount(0), m_File(nullptr),
+      m_Mapping(nullptr) {}
+
+AssetPack::~AssetPack() {
+  Close();
+}
+
+bool AssetPack::Open(const std::string& path) {
+  Close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  HANDLE mapping = nullptr;
+  if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  }
+  void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!view) {
+    if (mapping) {
+      CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    std::cerr << "Failed to map asset pack: " << path << std::endl;
+    return false;
+  }
+  m_File = file;
+  m_Mapping = mapping;
+  m_Data = (const uint8_t*)view;
+  m_Size = (size_t)fileSize.QuadPart;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  void* view = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping keeps the file alive
+  close(fd);
+  if (view == MAP_FAILED) {
+    std::cerr << "Failed to map asset pack: " << path << std::endl;
+    return false;
+  }
+  m_Data = (const uint8_t*)view;
+  m_Size = (size_t)info.st_size;
+#endif
+
+  // Validate everything Find and GetData will trust
+  const AssetPackHeader* header = (const AssetPackHeader*)m_Data;
+  bool valid = m_Size >= sizeof(AssetPackHeader) &&
+               std::memcmp(header->magic, kAssetPackMagic, sizeof(kAssetPackMagic)) == 0 &&
+               header->version == kAssetPackVersion && header->tocOffset <= m_Size &&
+               header->entryCount <= (m_Size - header->tocOffset) / sizeof(AssetPackEntry) &&
+               header->tocOffset % alignof(AssetPackEntry) == 0;
+  if (valid) {
+    m_Entries = (const AssetPackEntry*)(m_Data + header->tocOffset);
+    m_EntryCount = header->entryCount;
+    for (uint32_t i = 0; i < m_EntryCount && valid; i++) {
+      const AssetPackEntry& entry = m_Entries[i];
+      valid = entry.offset <= m_Size && entry.size <= m_Size - entry.offset &&
+              (i == 0 || m_Entries[i - 1].hash < entry.hash) && IsEntryInfoValid(entry);
+    }
+  }
+  if (!valid) {
+    std::cerr << "Invalid or outdated asset pack: " << path << std::endl;
+    Close();
+    return false;
+  }
+
+  std::cout << "Asset pack mapped: " << path << " (" << m_EntryCount << " assets, "
+            << m_Size / 1024 << " KB)" << std::endl;
+  return true;
+}
+
+void AssetPack::Close() {
+  if (!m_Data) {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(m_Data);
+  CloseHandle((HANDLE)m_Mapping);
+  CloseHandle((HANDLE)m_File);
+#else
+  munmap((void*)m_Data, m_Size);
+#endif
+  m_Data = nullptr;
+  m_Size = 0;
+  m_Entries = nullptr;
+  m_EntryCount = 0;
+  m_File = nullptr;
+  m_Mapping = nullptr;
+}
+
+const AssetPackEntry* AssetPack::Find(const std::string& path) const {
+  if (!m_Entries) {
+    return nullptr;
+  }
+  uint64_t hash = HashAssetPath(path);
+  const AssetPackEntry* end = m_Entries + m_EntryCount;
+  const AssetPackEntry* entry = std::lower_bound(
+      m_Entries, end, hash,
+      [](const AssetPackEntry& candidate, uint64_t value) { return candidate.hash < value; });
+  return entry != end && entry->hash == hash ? entry : nullptr;
+}
+
+bool AssetPack::MatchesSource(const AssetPackEntry& entry, const std::string& path) {
+  std::error_code error;
+  uintmax_t size = std::filesystem::file_size(path, error);
+  if (error) {
+    return true;
+  }
+  std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+  return !error && size == entry.sourceSize &&
+         (int64_t)time.time_since_epoch().count() == entry.sourceTime;
+}
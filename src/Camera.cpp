@@ -19,6 +19,14 @@ glm::mat4 Camera::GetProjectionMatrix(int screenWidth, int screenHeight) const {
   return glm::ortho(0.0f, (float)screenWidth, (float)screenHeight, 0.0f, -1.0f, 1.0f);
 }
 
+glm::vec4 Camera::GetViewRect(float margin) const {
+  // The view matrix puts position at the screen center
+  float halfWidth = m_ScreenWidth / 2.0f + margin;
+  float halfHeight = m_ScreenHeight / 2.0f + margin;
+  return glm::vec4(position.x - halfWidth, position.y - halfHeight,
+                   position.x + halfWidth, position.y + halfHeight);
+}
+
 void Camera::Follow(const glm::vec2& targetPosition, float deltaTime) {
   // For simplicity, just set position to target position
   // Can be extended with interpolation or smoothing later
@@ -0,0 +1,221 @@
+#include "DebugDraw.h"
+
+#ifdef LEO_DEBUG_DRAW
+
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+// 3x5 glyphs for ASCII 32-95, bit (row * 3 + column) set for a lit pixel,
+// row 0 at the top. Lower case letters use the upper case glyphs.
+const uint16_t kFont[64] = {
+    0x0000, 0x2092, 0x0000, 0x5F7D, 0x0000, 0x52A5, 0x0000, 0x0012,  // sp ! " # $ % & '
+    0x224A, 0x2922, 0x0AA8, 0x05D0, 0x1400, 0x01C0, 0x2000, 0x12A4,  // ( ) * + , - . /
+    0x7B6F, 0x749A, 0x73E7, 0x79A7, 0x49ED, 0x79CF, 0x7BCF, 0x24A7,  // 0 1 2 3 4 5 6 7
+    0x7BEF, 0x79EF, 0x0410, 0x0000, 0x4454, 0x0E38, 0x1511, 0x20A3,  // 8 9 : ; < = > ?
+    0x0000, 0x5BEA, 0x3AEB, 0x624E, 0x3B6B, 0x72CF, 0x12CF, 0x6B4E,  // @ A B C D E F G
+    0x5BED, 0x7497, 0x2B24, 0x5AED, 0x7249, 0x5BFD, 0x5B6B, 0x2B6A,  // H I J K L M N O
+    0x12EB, 0x676A, 0x5AEB, 0x388E, 0x2497, 0x7B6D, 0x2B6D, 0x5FED,  // P Q R S T U V W
+    0x5AAD, 0x24AD, 0x72A7, 0x324B, 0x0000, 0x6926, 0x0000, 0x7000,  // X Y Z [ \ ] ^ _
+};
+const int kGlyphColumns = 3;
+const int kGlyphRows = 5;
+
+}  // namespace
+
+DebugDraw* DebugDraw::s_Current = nullptr;
+
+DebugDraw::DebugDraw()
+    : m_Shader(nullptr), m_VertexStream(nullptr), m_VAO(0), m_LastLineCount(0),
+      m_LastTriangleCount(0) {
+  for (int i = 0; i <= kCircleSegments; i++) {
+    float angle = 2.0f * 3.14159265359f * i / kCircleSegments;
+    m_CircleOutline[i] = glm::vec2(std::cos(angle), std::sin(angle));
+  }
+}
+
+DebugDraw::~DebugDraw() {
+  Cleanup();
+}
+
+bool DebugDraw::Init(Shader* solidShader, StreamBuffer* vertexStream) {
+  m_Shader = solidShader;
+  m_VertexStream = vertexStream;
+
+  glGenVertexArrays(1, &m_VAO);
+  GLStateCache* state = GLStateCache::Get();
+  state->BindVertexArray(m_VAO);
+  state->BindBuffer(GL_ARRAY_BUFFER, m_VertexStream->GetID());
+
+  // Attributes start at offset 0 of the vertex stream; each draw picks its
+  // place in the ring with the first vertex of glDrawArrays. Texture coord
+  // and shape stay disabled and read constants.
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(DebugVertex),
+                        (void *)offsetof(DebugVertex, position));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugVertex),
+                        (void *)offsetof(DebugVertex, color));
+  glEnableVertexAttribArray(2);
+
+  state->BindVertexArray(0);
+  return true;
+}
+
+void DebugDraw::Cleanup() {
+  if (m_VAO != 0) {
+    GLStateCache::Get()->DeleteVertexArray(m_VAO);
+    m_VAO = 0;
+  }
+  m_LineVertices.clear();
+  m_TriangleVertices.clear();
+}
+
+uint32_t DebugDraw::PackColor(glm::vec4 color) {
+  glm::vec4 bytes = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+  // Little-endian: red in the lowest byte, as GL_UNSIGNED_BYTE reads it
+  return (uint32_t)bytes.r | (uint32_t)bytes.g << 8 | (uint32_t)bytes.b << 16 |
+         (uint32_t)bytes.a << 24;
+}
+
+void DebugDraw::AddLine(glm::vec2 from, glm::vec2 to, uint32_t color) {
+  m_LineVertices.push_back({from, color});
+  m_LineVertices.push_back({to, color});
+}
+
+void DebugDraw::AddQuad(glm::vec2 min, glm::vec2 max, uint32_t color) {
+  m_TriangleVertices.push_back({glm::vec2(min.x, min.y), color});
+  m_TriangleVertices.push_back({glm::vec2(max.x, min.y), color});
+  m_TriangleVertices.push_back({glm::vec2(max.x, max.y), color});
+  m_TriangleVertices.push_back({glm::vec2(min.x, min.y), color});
+  m_TriangleVertices.push_back({glm::vec2(max.x, max.y), color});
+  m_TriangleVertices.push_back({glm::vec2(min.x, max.y), color});
+}
+
+void DebugDraw::Line(glm::vec2 from, glm::vec2 to, glm::vec4 color) {
+  if (s_Current) {
+    s_Current->AddLine(from, to, PackColor(color));
+  }
+}
+
+void DebugDraw::Rect(const glm::vec4& box, glm::vec4 color, bool filled) {
+  if (!s_Current) {
+    return;
+  }
+  glm::vec2 halfSize(box.z * 0.5f, box.w * 0.5f);
+  glm::vec2 min = glm::vec2(box.x, box.y) - halfSize;
+  glm::vec2 max = glm::vec2(box.x, box.y) + halfSize;
+  uint32_t packed = PackColor(color);
+  if (filled) {
+    s_Current->AddQuad(min, max, packed);
+    return;
+  }
+  s_Current->AddLine(min, glm::vec2(max.x, min.y), packed);
+  s_Current->AddLine(glm::vec2(max.x, min.y), max, packed);
+  s_Current->AddLine(max, glm::vec2(min.x, max.y), packed);
+  s_Current->AddLine(glm::vec2(min.x, max.y), min, packed);
+}
+
+void DebugDraw::Circle(glm::vec2 center, float radius, glm::vec4 color, bool filled) {
+  if (!s_Current) {
+    return;
+  }
+  uint32_t packed = PackColor(color);
+  const glm::vec2* outline = s_Current->m_CircleOutline;
+  for (int i = 0; i < kCircleSegments; i++) {
+    glm::vec2 from = center + outline[i] * radius;
+    glm::vec2 to = center + outline[i + 1] * radius;
+    if (filled) {
+      s_Current->m_TriangleVertices.push_back({center, packed});
+      s_Current->m_TriangleVertices.push_back({from, packed});
+      s_Current->m_TriangleVertices.push_back({to, packed});
+    } else {
+      s_Current->AddLine(from, to, packed);
+    }
+  }
+}
+
+void DebugDraw::Text(glm::vec2 position, const char* text, glm::vec4 color, float pixelSize) {
+  if (!s_Current || !text) {
+    return;
+  }
+  uint32_t packed = PackColor(color);
+  glm::vec2 pen = position;
+  for (const char* c = text; *c; c++) {
+    if (*c == '\n') {
+      pen.x = position.x;
+      pen.y += (kGlyphRows + 1) * pixelSize;
+      continue;
+    }
+    int code = (unsigned char)*c;
+    if (code >= 'a' && code <= 'z') {
+      code -= 'a' - 'A';
+    }
+    uint16_t glyph = (code >= 32 && code < 96) ? kFont[code - 32] : kFont['?' - 32];
+
+    // One quad per horizontal run of lit pixels
+    for (int row = 0; row < kGlyphRows; row++) {
+      int column = 0;
+      while (column < kGlyphColumns) {
+        if (!(glyph & (1u << (row * kGlyphColumns + column)))) {
+          column++;
+          continue;
+        }
+        int start = column;
+        while (column < kGlyphColumns && (glyph & (1u << (row * kGlyphColumns + column)))) {
+          column++;
+        }
+        s_Current->AddQuad(pen + glm::vec2(start, row) * pixelSize,
+                           pen + glm::vec2(column, row + 1) * pixelSize, packed);
+      }
+    }
+    pen.x += (kGlyphColumns + 1) * pixelSize;
+  }
+}
+
+void DebugDraw::Flush() {
+  m_LastLineCount = (int)m_LineVertices.size() / 2;
+  m_LastTriangleCount = (int)m_TriangleVertices.size() / 3;
+  if (m_LineVertices.empty() && m_TriangleVertices.empty()) {
+    return;
+  }
+
+  GLStateCache* state = GLStateCache::Get();
+  m_Shader->Use();
+  state->BindVertexArray(m_VAO);
+  state->BindBuffer(GL_ARRAY_BUFFER, m_VertexStream->GetID());
+  // Shape kind 0 in the disabled shape attribute draws plain color
+  glVertexAttrib4f(3, 0.0f, 0.0f, 0.0f, 0.0f);
+
+  // Filled shapes and text under outlines
+  DrawVertices(GL_TRIANGLES, m_TriangleVertices);
+  DrawVertices(GL_LINES, m_LineVertices);
+
+  m_LineVertices.clear();
+  m_TriangleVertices.clear();
+}
+
+void DebugDraw::DrawVertices(GLenum mode, const std::vector<DebugVertex>& vertices) {
+  // Only very large frames need more than one draw per mode
+  RenderStats* stats = RenderStats::Get();
+  for (size_t first = 0; first < vertices.size(); first += kMaxVerticesPerDraw) {
+    size_t count = std::min(kMaxVerticesPerDraw, vertices.size() - first);
+    size_t bytes = count * sizeof(DebugVertex);
+    GLintptr offset = 0;
+    void* mapping = m_VertexStream->Map(bytes, sizeof(DebugVertex), offset);
+    if (!mapping) {
+      return;
+    }
+    std::memcpy(mapping, vertices.data() + first, bytes);
+    m_VertexStream->Commit(bytes);
+
+    glDrawArrays(mode, (GLint)(offset / sizeof(DebugVertex)), (GLsizei)count);
+    stats->AddDrawCall(mode == GL_TRIANGLES ? (int)count / 3 : 0);
+  }
+}
+
+#endif // LEO_DEBUG_DRAW
@@ -0,0 +1,117 @@
+#include "DynamicResolution.h"
+#include "GLStateCache.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+DynamicResolution::DynamicResolution()
+    : m_FBO(0), m_ColorTexture(0), m_Width(0), m_Height(0), m_BudgetMs(0.0),
+      m_MinScale(0.5f), m_Scale(1.0f), m_SmoothedMs(0.0), m_FramesSinceChange(0) {}
+
+DynamicResolution::~DynamicResolution() {
+  Cleanup();
+}
+
+bool DynamicResolution::Init(int width, int height, double budgetMs, float minScale) {
+  m_Width = width;
+  m_Height = height;
+  m_BudgetMs = budgetMs;
+  m_MinScale = std::clamp(minScale, kScaleStep, 1.0f);
+  m_Scale = 1.0f;
+
+  GLStateCache* state = GLStateCache::Get();
+  glGenTextures(1, &m_ColorTexture);
+  state->BindTexture(m_ColorTexture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               nullptr);
+  // Bilinear upscale; clamp so the window edges do not wrap around
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  glGenFramebuffers(1, &m_FBO);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         m_ColorTexture, 0);
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Dynamic resolution framebuffer incomplete: 0x" << std::hex << status
+              << std::dec << std::endl;
+    Cleanup();
+    return false;
+  }
+  return true;
+}
+
+void DynamicResolution::Cleanup() {
+  if (m_FBO != 0) {
+    glDeleteFramebuffers(1, &m_FBO);
+    m_FBO = 0;
+  }
+  if (m_ColorTexture != 0) {
+    GLStateCache::Get()->DeleteTexture(m_ColorTexture);
+    m_ColorTexture = 0;
+  }
+}
+
+void DynamicResolution::Update(double frameMs) {
+  m_SmoothedMs = (m_SmoothedMs <= 0.0) ? frameMs
+                                        : m_SmoothedMs + (frameMs - m_SmoothedMs) * kSmoothing;
+  if (++m_FramesSinceChange < kCooldownFrames) {
+    return;
+  }
+
+  float scale = m_Scale;
+  if (m_SmoothedMs > m_BudgetMs) {
+    // Pixel cost is quadratic in the scale; round down so it always drops
+    float wanted = m_Scale * (float)std::sqrt(m_BudgetMs / m_SmoothedMs);
+    scale = std::floor(wanted / kScaleStep + 0.001f) * kScaleStep;
+    scale = std::min(scale, m_Scale - kScaleStep);
+  } else if (m_SmoothedMs < m_BudgetMs * kRaiseThreshold) {
+    scale = m_Scale + kScaleStep;
+  }
+  scale = std::clamp(scale, m_MinScale, 1.0f);
+
+  if (std::fabs(scale - m_Scale) > kScaleStep * 0.5f) {
+    m_Scale = scale;
+    m_FramesSinceChange = 0;
+  }
+}
+
+int DynamicResolution::GetScaledWidth() const {
+  return std::max(1, (int)(m_Width * m_Scale + 0.5f));
+}
+
+int DynamicResolution::GetScaledHeight() const {
+  return std::max(1, (int)(m_Height * m_Scale + 0.5f));
+}
+
+void DynamicResolution::Begin() {
+  glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+  glViewport(0, 0, GetScaledWidth(), GetScaledHeight());
+}
+
+void DynamicResolution::End() {
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glViewport(0, 0, m_Width, m_Height);
+}
+
+void DynamicResolution::Composite(SpriteBatch& batch) {
+  // The scaled image fills the lower-left corner of the texture, and GL rows
+  // run bottom-up, so v runs from the corner's top down to 0. The far edges
+  // stop half a texel inside the rendered region so bilinear filtering never
+  // blends in the stale texels beyond it; the near edges are covered by
+  // GL_CLAMP_TO_EDGE.
+  float u = (GetScaledWidth() - 0.5f) / m_Width;
+  float v = (GetScaledHeight() - 0.5f) / m_Height;
+
+  // Replace, don't blend: the target's alpha is whatever blending left there
+  glDisable(GL_BLEND);
+  batch.Begin();
+  batch.SubmitQuad(m_ColorTexture, glm::vec2(m_Width * 0.5f, m_Height * 0.5f),
+                   glm::vec2((float)m_Width, (float)m_Height), glm::vec4(0.0f, v, u, -v));
+  batch.End();
+  glEnable(GL_BLEND);
+}
@@ -0,0 +1,231 @@
+#include "FrameCapture.h"
+#include "GLStateCache.h"
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+static const char* kPipeMode = "wb";
+#else
+static const char* kPipeMode = "w";
+#endif
+
+FrameCapture::FrameCapture()
+    : m_Width(0), m_Height(0), m_FrameBytes(0), m_Output(Output::PNG), m_File(nullptr),
+      m_Slots{}, m_NextSlot(0), m_Captured(0), m_Dropped(0), m_LastCaptureMs(0.0),
+      m_Stopping(false), m_Failed(false) {}
+
+FrameCapture::~FrameCapture() {
+  Cleanup();
+}
+
+bool FrameCapture::Init(int width, int height, const std::string& target) {
+  m_Width = width;
+  m_Height = height;
+  m_FrameBytes = (size_t)width * height * 4;
+
+  if (!target.empty() && target[0] == '|') {
+    m_Output = Output::Pipe;
+    m_Target = target.substr(1);
+#ifndef _WIN32
+    // An encoder that exits early would otherwise kill the game with SIGPIPE;
+    // ignored, the write fails with EPIPE and capture stops
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    m_File = popen(m_Target.c_str(), kPipeMode);
+  } else if (target.size() > 4 && target.compare(target.size() - 4, 4, ".raw") == 0) {
+    m_Output = Output::Raw;
+    m_Target = target;
+    m_File = std::fopen(m_Target.c_str(), "wb");
+  } else {
+    m_Output = Output::PNG;
+    m_Target = target;
+  }
+  if (m_Output != Output::PNG && !m_File) {
+    std::cerr << "Failed to open capture target: " << target << std::endl;
+    return false;
+  }
+
+  GLStateCache* state = GLStateCache::Get();
+  for (Slot& slot : m_Slots) {
+    glGenBuffers(1, &slot.buffer);
+    state->BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, m_FrameBytes, nullptr, GL_STREAM_READ);
+    slot.fence = nullptr;
+  }
+  state->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  m_Stopping = false;
+  m_Failed = false;
+  m_Writer = std::thread(&FrameCapture::WriterLoop, this);
+  std::cout << "Capturing " << width << "x" << height << " frames to " << target << std::endl;
+  return true;
+}
+
+void FrameCapture::Cleanup() {
+  if (m_Slots[0].buffer == 0) {
+    return;
+  }
+
+  // Oldest first, so frames reach the writer in order
+  for (int i = 0; i < kRingSize; i++) {
+    Slot& slot = m_Slots[(m_NextSlot + i) % kRingSize];
+    if (slot.fence) {
+      Collect(slot);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stopping = true;
+  }
+  m_FrameReady.notify_all();
+  if (m_Writer.joinable()) {
+    m_Writer.join();
+  }
+
+  if (m_File) {
+    if (m_Output == Output::Pipe) {
+      pclose(m_File);
+    } else {
+      std::fclose(m_File);
+    }
+    m_File = nullptr;
+  }
+
+  GLStateCache* state = GLStateCache::Get();
+  for (Slot& slot : m_Slots) {
+    state->DeleteBuffer(slot.buffer);
+    slot.buffer = 0;
+  }
+  // Only frames the writer gave up on after a failed write remain
+  m_Dropped += (int)m_Queue.size();
+  m_Queue.clear();
+  m_FreeBuffers.clear();
+  std::cout << "Captured " << (m_Captured - m_Dropped) << " frames (" << m_Dropped
+            << " dropped)" << std::endl;
+}
+
+void FrameCapture::Capture() {
+  if (m_Slots[0].buffer == 0 || m_Failed) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  // The ring wrapped: this slot's frame is kRingSize frames old
+  Slot& slot = m_Slots[m_NextSlot];
+  if (slot.fence) {
+    Collect(slot);
+  }
+
+  // With a pack buffer bound the read only queues a copy on the GPU
+  GLStateCache* state = GLStateCache::Get();
+  state->BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  state->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot.frame = m_Captured++;
+  m_NextSlot = (m_NextSlot + 1) % kRingSize;
+
+  m_LastCaptureMs = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+}
+
+void FrameCapture::Collect(Slot& slot) {
+  // Normally signaled long ago; waits only if the GPU is frames behind
+  glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+  glDeleteSync(slot.fence);
+  slot.fence = nullptr;
+
+  Frame frame;
+  frame.index = slot.frame;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if ((int)m_Queue.size() >= kMaxQueuedFrames) {
+      m_Dropped++;
+      return;
+    }
+    if (!m_FreeBuffers.empty()) {
+      frame.pixels = std::move(m_FreeBuffers.back());
+      m_FreeBuffers.pop_back();
+    }
+  }
+  frame.pixels.resize(m_FrameBytes);
+
+  GLStateCache* state = GLStateCache::Get();
+  state->BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  void* mapping = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_FrameBytes, GL_MAP_READ_BIT);
+  if (mapping) {
+    std::memcpy(frame.pixels.data(), mapping, m_FrameBytes);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  state->BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (!mapping) {
+    m_Dropped++;
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Queue.push_back(std::move(frame));
+  }
+  m_FrameReady.notify_one();
+}
+
+void FrameCapture::WriterLoop() {
+  std::vector<uint8_t> flipped(m_FrameBytes);
+  for (;;) {
+    Frame frame;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_FrameReady.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+      // Drains the queue before stopping
+      if (m_Queue.empty()) {
+        return;
+      }
+      frame = std::move(m_Queue.front());
+      m_Queue.pop_front();
+    }
+
+    bool written = WriteFrame(frame, flipped);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!written) {
+      // Left queued so Cleanup counts it with the rest as dropped
+      m_Queue.push_front(std::move(frame));
+      m_Failed = true;
+      return;
+    }
+    m_FreeBuffers.push_back(std::move(frame.pixels));
+  }
+}
+
+bool FrameCapture::WriteFrame(const Frame& frame, std::vector<uint8_t>& flipped) {
+  // GL rows run bottom-up, images and encoders expect top-down
+  size_t rowBytes = (size_t)m_Width * 4;
+  for (int y = 0; y < m_Height; y++) {
+    std::memcpy(flipped.data() + y * rowBytes,
+                frame.pixels.data() + (size_t)(m_Height - 1 - y) * rowBytes, rowBytes);
+  }
+
+  if (m_Output == Output::PNG) {
+    char path[1024];
+    std::snprintf(path, sizeof(path), "%s_%06d.png", m_Target.c_str(), frame.index);
+    if (!stbi_write_png(path, m_Width, m_Height, 4, flipped.data(), (int)rowBytes)) {
+      std::cerr << "Failed to write capture frame: " << path << std::endl;
+    }
+    return true;
+  }
+  if (std::fwrite(flipped.data(), 1, m_FrameBytes, m_File) != m_FrameBytes) {
+    std::cerr << "Failed to write capture frame " << frame.index << ", stopping capture"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
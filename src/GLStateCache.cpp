@@ -0,0 +1,209 @@
+#include "GLStateCache.h"
+
+// Sentinel that never matches a real object name, forces the next bind
+static constexpr GLuint kUnknown = 0xFFFFFFFFu;
+
+GLStateCache* GLStateCache::s_Current = nullptr;
+
+GLStateCache::GLStateCache() : m_Issued(0), m_Skipped(0) {
+  Invalidate();
+}
+
+void GLStateCache::Invalidate() {
+  m_Program = kUnknown;
+  m_VertexArray = kUnknown;
+  m_ActiveUnit = -1;
+  for (int i = 0; i < kMaxTextureUnits; i++) {
+    m_Textures[i] = kUnknown;
+    m_BufferTextures[i] = kUnknown;
+  }
+  m_ArrayBuffer = kUnknown;
+  m_UniformBuffer = kUnknown;
+  m_PixelPackBuffer = kUnknown;
+  m_PixelUnpackBuffer = kUnknown;
+  for (int i = 0; i < kMaxUniformBindings; i++) {
+    m_UniformRanges[i] = {kUnknown, 0, 0};
+  }
+}
+
+bool GLStateCache::Track(GLuint& current, GLuint value) {
+  if (current == value) {
+    m_Skipped++;
+    return false;
+  }
+  current = value;
+  m_Issued++;
+  return true;
+}
+
+void GLStateCache::UseProgram(GLuint program) {
+  if (Track(m_Program, program)) {
+    glUseProgram(program);
+  }
+}
+
+void GLStateCache::BindVertexArray(GLuint vertexArray) {
+  if (Track(m_VertexArray, vertexArray)) {
+    glBindVertexArray(vertexArray);
+  }
+}
+
+void GLStateCache::ActiveTexture(GLenum unit) {
+  int index = (int)(unit - GL_TEXTURE0);
+  if (index == m_ActiveUnit) {
+    m_Skipped++;
+    return;
+  }
+  m_ActiveUnit = index;
+  m_Issued++;
+  glActiveTexture(unit);
+}
+
+void GLStateCache::BindTexture(GLuint texture) {
+  // Uploads and single-texture draws use unit 0
+  BindTexture(GL_TEXTURE0, texture);
+}
+
+void GLStateCache::BindTexture(GLenum unit, GLuint texture) {
+  BindTexture(unit, GL_TEXTURE_2D, texture);
+}
+
+void GLStateCache::BindTexture(GLenum unit, GLenum target, GLuint texture) {
+  GLuint* slot = TextureSlot(target, (int)(unit - GL_TEXTURE0));
+  if (!slot) {
+    ActiveTexture(unit);
+    glBindTexture(target, texture);
+    m_Issued++;
+    return;
+  }
+  if (*slot == texture) {
+    m_Skipped++;
+    return;
+  }
+  ActiveTexture(unit);
+  *slot = texture;
+  m_Issued++;
+  glBindTexture(target, texture);
+}
+
+GLuint* GLStateCache::TextureSlot(GLenum target, int unit) {
+  if (unit < 0 || unit >= kMaxTextureUnits) {
+    return nullptr;
+  }
+  switch (target) {
+  case GL_TEXTURE_2D:
+    return &m_Textures[unit];
+  case GL_TEXTURE_BUFFER:
+    return &m_BufferTextures[unit];
+  default:
+    return nullptr;
+  }
+}
+
+GLuint* GLStateCache::BufferSlot(GLenum target) {
+  switch (target) {
+  case GL_ARRAY_BUFFER:
+    return &m_ArrayBuffer;
+  case GL_UNIFORM_BUFFER:
+    return &m_UniformBuffer;
+  case GL_PIXEL_PACK_BUFFER:
+    return &m_PixelPackBuffer;
+  case GL_PIXEL_UNPACK_BUFFER:
+    return &m_PixelUnpackBuffer;
+  default:
+    // GL_ELEMENT_ARRAY_BUFFER is vertex array state, never cached
+    return nullptr;
+  }
+}
+
+void GLStateCache::BindBuffer(GLenum target, GLuint buffer) {
+  GLuint* slot = BufferSlot(target);
+  if (!slot) {
+    m_Issued++;
+    glBindBuffer(target, buffer);
+    return;
+  }
+  if (Track(*slot, buffer)) {
+    glBindBuffer(target, buffer);
+  }
+}
+
+void GLStateCache::BindBufferRange(GLenum target, GLuint index, GLuint buffer,
+                                   GLintptr offset, GLsizeiptr size) {
+  if (target == GL_UNIFORM_BUFFER && index < (GLuint)kMaxUniformBindings) {
+    BufferRange& range = m_UniformRanges[index];
+    if (range.buffer == buffer && range.offset == offset && range.size == size) {
+      m_Skipped++;
+      return;
+    }
+    range = {buffer, offset, size};
+  }
+  m_Issued++;
+  glBindBufferRange(target, index, buffer, offset, size);
+
+  // Also changes the generic binding point
+  GLuint* slot = BufferSlot(target);
+  if (slot) {
+    *slot = buffer;
+  }
+}
+
+void GLStateCache::DeleteTexture(GLuint texture) {
+  if (texture == 0) {
+    return;
+  }
+  glDeleteTextures(1, &texture);
+  for (int i = 0; i < kMaxTextureUnits; i++) {
+    if (m_Textures[i] == texture) {
+      m_Textures[i] = 0;
+    }
+    if (m_BufferTextures[i] == texture) {
+      m_BufferTextures[i] = 0;
+    }
+  }
+}
+
+void GLStateCache::DeleteBuffer(GLuint buffer) {
+  if (buffer == 0) {
+    return;
+  }
+  glDeleteBuffers(1, &buffer);
+  GLuint* slots[] = {&m_ArrayBuffer, &m_UniformBuffer, &m_PixelPackBuffer,
+                     &m_PixelUnpackBuffer};
+  for (GLuint* slot : slots) {
+    if (*slot == buffer) {
+      *slot = 0;
+    }
+  }
+  for (int i = 0; i < kMaxUniformBindings; i++) {
+    if (m_UniformRanges[i].buffer == buffer) {
+      m_UniformRanges[i] = {0, 0, 0};
+    }
+  }
+}
+
+void GLStateCache::DeleteVertexArray(GLuint vertexArray) {
+  if (vertexArray == 0) {
+    return;
+  }
+  glDeleteVertexArrays(1, &vertexArray);
+  if (m_VertexArray == vertexArray) {
+    m_VertexArray = 0;
+  }
+}
+
+void GLStateCache::DeleteProgram(GLuint program) {
+  if (program == 0) {
+    return;
+  }
+  // A current program stays in use until replaced, but its name may be reused
+  glDeleteProgram(program);
+  if (m_Program == program) {
+    m_Program = kUnknown;
+  }
+}
+
+void GLStateCache::ResetCounters() {
+  m_Issued = 0;
+  m_Skipped = 0;
+}
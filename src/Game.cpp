@@ -2,14 +2,28 @@
 #include "Animation.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <iostream>
 
 Game::Game()
     : isRunning(false), window(nullptr), glContext(nullptr),
       m_Renderer(nullptr), m_InputManager(nullptr), 
       m_ResourceManager(nullptr), m_Scene(nullptr),
-      m_Camera(nullptr), m_ScreenWidth(800), m_ScreenHeight(600),
-      m_WasColliding(false) {}
+      m_Camera(nullptr), m_ThreadPool(nullptr), m_Tilemap(nullptr), m_Particles(nullptr),
+      m_DynamicResolution(nullptr), m_FrameCapture(nullptr), m_LayerCaches{}, m_UseLayerCache(true),
+      m_ScreenWidth(800), m_ScreenHeight(600),
+      m_WasColliding(false), m_SpriteBatchMode(SpriteBatchMode::Instanced),
+      m_PrintRenderStats(false), m_ShowDebugOverlay(false), m_ResolutionBudgetMs(0.0),
+      m_AssetPackPath("assets.pak"),
+      m_ScoreText("SCORE: 100"), m_IdleSkip(true), m_Dirty(true), m_DrawnSceneRevision(0),
+      m_DrawnCameraPosition(0.0f),
+      m_BenchmarkSprites(0), m_BenchmarkTiles(0), m_BenchmarkParticles(0),
+      m_BenchmarkLights(0), m_BenchmarkAnimated(0), m_BenchmarkStreaming(0), m_LightTime(0.0f),
+      m_BenchStartCounter(0),
+      m_BenchLastCounter(0), m_BenchFrames(0), m_BenchFrameTimeMs(0.0), m_BenchWorstFrameMs(0.0),
+      m_BenchTotalFrames(0), m_BenchTotalFrameTimeMs(0.0) {}
 
 Game::~Game() {
   // Clean() should be called before destructor, but just in case:
@@ -21,6 +35,9 @@ void Game::Init(const char *title, int width, int height, bool fullscreen) {
   m_ScreenHeight = height;
   
   InitSDL();
+  // Workers record render commands; GL calls stay on this thread
+  m_ThreadPool = new ThreadPool();
+  std::cout << "Thread pool: " << m_ThreadPool->GetThreadCount() << " workers" << std::endl;
   InitOpenGL();
   InitResources();
   InitScene();
@@ -105,6 +122,28 @@ void Game::InitOpenGL() {
     isRunning = false;
     return;
   }
+  m_Renderer->GetSpriteBatch()->SetMode(m_SpriteBatchMode);
+  if (m_PrintRenderStats) {
+    m_Renderer->GetStats()->SetPrintInterval(1.0);
+  }
+  if (!m_RenderStatsCSV.empty()) {
+    m_Renderer->GetStats()->OpenCSV(m_RenderStatsCSV);
+  }
+  if (m_ResolutionBudgetMs > 0.0) {
+    m_DynamicResolution = new DynamicResolution();
+    if (!m_DynamicResolution->Init(m_ScreenWidth, m_ScreenHeight, m_ResolutionBudgetMs)) {
+      // Fall back to rendering straight to the window
+      delete m_DynamicResolution;
+      m_DynamicResolution = nullptr;
+    }
+  }
+  if (!m_CaptureTarget.empty()) {
+    m_FrameCapture = new FrameCapture();
+    if (!m_FrameCapture->Init(m_ScreenWidth, m_ScreenHeight, m_CaptureTarget)) {
+      delete m_FrameCapture;
+      m_FrameCapture = nullptr;
+    }
+  }
   
   // Initialize InputManager
   m_InputManager = new InputManager();
@@ -113,14 +152,20 @@ void Game::InitOpenGL() {
 void Game::InitResources() {
   // Initialize ResourceManager
   m_ResourceManager = new ResourceManager();
+  if (!m_AssetPackPath.empty() && !m_ResourceManager->OpenPack(m_AssetPackPath)) {
+    std::cout << "No asset pack at " << m_AssetPackPath << ", loading loose files" << std::endl;
+  }
   
   // Load textures
-  m_ResourceManager->LoadTexture("player", "assets/Character/knight.png");
+  m_ResourceManager->LoadSpriteSheet("player", "assets/Character/knight.png", 16, 16);
+  m_ResourceManager->LoadSpriteSheet("tiles", "assets/Tiles/tiles.png", 16, 16);
   
   // Load sounds
   m_ResourceManager->LoadMusic("background", "assets/background.ogg");
   m_ResourceManager->LoadSound("jump", "assets/jump.wav");
   m_ResourceManager->LoadSound("collision", "assets/Audio/collision.wav");
+  m_JumpSound = m_ResourceManager->GetSoundHandle("jump");
+  m_CollisionSound = m_ResourceManager->GetSoundHandle("collision");
   
   // Load font
   m_ResourceManager->LoadFont("assets/Font/Roboto-Bold.ttf", 24);
@@ -139,7 +184,7 @@ void Game::InitScene() {
   
   // Create GameObjects
   // Player object (first in vector)
-  Texture* playerTexture = m_ResourceManager->GetTexture("player");
+  TextureHandle playerTexture = m_ResourceManager->GetTextureHandle("player");
   GameObject* player = new GameObject(glm::vec2(400.0f, 300.0f), 
                                       glm::vec2(100.0f, 100.0f), 
                                       playerTexture);
@@ -147,8 +192,9 @@ void Game::InitScene() {
   // Create animation for player using knight sprite sheet
   // Assuming: 8 frames in the first row, each frame is 16x16 pixels
   // Get actual texture dimensions to calculate UV coordinates
-  int sheetWidth = playerTexture->GetWidth();
-  int sheetHeight = playerTexture->GetHeight();
+  const Texture* playerSheet = m_ResourceManager->GetTexture(playerTexture);
+  int sheetWidth = playerSheet->GetWidth();
+  int sheetHeight = playerSheet->GetHeight();
   
   // Frame dimensions in pixels
   const int frameWidthPx = 16;
@@ -173,17 +219,163 @@ void Game::InitScene() {
   
   m_Scene->AddGameObject(player);
 
-  // Static reference object (red circle) - second in vector
+  // Animated crowd: each knight only stores the clip and a start time, the
+  // vertex shader picks its frame
+  if (m_BenchmarkAnimated > 0) {
+    AnimationClips* clips = m_Renderer->GetAnimationClips();
+    int walkClip = clips->AddClip(playerSheet, walkFrames, 0.1f);
+    int columns = (int)std::ceil(std::sqrt((float)m_BenchmarkAnimated));
+    for (int i = 0; i < m_BenchmarkAnimated; i++) {
+      glm::vec2 gridPos((float)(i % columns), (float)(i / columns));
+      GameObject* knight = new GameObject(glm::vec2(-600.0f, -600.0f) + gridPos * 20.0f,
+                                          glm::vec2(16.0f, 16.0f), playerTexture);
+      knight->animationClip = walkClip;
+      // Spread over one cycle so the crowd does not step in unison
+      knight->animationStart = -0.1f * (i % (int)walkFrames.size());
+      m_Scene->AddGameObject(knight);
+    }
+    std::cout << "[Benchmark] " << m_BenchmarkAnimated << " GPU-animated sprites" << std::endl;
+  }
+
+  // Static reference object (red circle)
   GameObject* referencePoint = new GameObject(glm::vec2(400.0f, 300.0f),
-                                              glm::vec2(50.0f, 50.0f),
-                                              nullptr);
+                                              glm::vec2(100.0f, 100.0f),
+                                              TextureHandle());
+  referencePoint->shape = SpriteShape::Circle;
+  referencePoint->useColor = true;
+  referencePoint->color = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
   m_Scene->AddGameObject(referencePoint);
 
-  // Wall object (immobile) - third in vector
+  // Wall object (immobile)
   GameObject* wall = new GameObject(glm::vec2(600.0f, 200.0f),
                                     glm::vec2(150.0f, 100.0f),
-                                    nullptr);
+                                    TextureHandle());
+  wall->useColor = true;
+  wall->color = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+  wall->layer = RenderLayer::Background;
   m_Scene->AddGameObject(wall);
+
+  // Nothing on the background moves, so it is drawn from a cached image
+  m_Scene->SetLayerStatic(RenderLayer::Background, true);
+
+  // Benchmark sprites - a grid of static textured quads around the player
+  if (m_BenchmarkSprites > 0) {
+    int columns = (int)std::ceil(std::sqrt((float)m_BenchmarkSprites));
+    for (int i = 0; i < m_BenchmarkSprites; i++) {
+      glm::vec2 gridPos((float)(i % columns), (float)(i / columns));
+      GameObject* sprite = new GameObject(glm::vec2(-1000.0f, -1000.0f) + gridPos * 24.0f,
+                                          glm::vec2(16.0f, 16.0f),
+                                          playerTexture);
+      // Kept on the World layer so the batching benchmark measures per-sprite
+      // submission, not one cached layer image
+      m_Scene->AddGameObject(sprite);
+    }
+    std::cout << "[Benchmark] " << m_BenchmarkSprites << " sprites" << std::endl;
+  }
+
+  if (m_BenchmarkTiles > 0) {
+    InitTilemap();
+  }
+
+  m_Particles = new ParticleSystem();
+  if (m_BenchmarkParticles > 0) {
+    InitParticles();
+  }
+
+  // Sprites show the checkerboard until their texture has streamed in
+  if (m_BenchmarkStreaming > 0) {
+    const char* images[] = {"assets/char.png", "assets/Character/knight.png",
+                            "assets/Tiles/tiles.png"};
+    int columns = (int)std::ceil(std::sqrt((float)m_BenchmarkStreaming));
+    for (int i = 0; i < m_BenchmarkStreaming; i++) {
+      TextureHandle texture = m_ResourceManager->LoadTextureAsync(
+          AssetId::FromString("streamed" + std::to_string(i)), images[i % 3], m_ThreadPool);
+      glm::vec2 gridPos((float)(i % columns), (float)(i / columns));
+      m_Scene->AddGameObject(new GameObject(glm::vec2(100.0f, 100.0f) + gridPos * 36.0f,
+                                            glm::vec2(32.0f, 32.0f), texture));
+    }
+    std::cout << "[Benchmark] " << m_BenchmarkStreaming << " streamed textures" << std::endl;
+  }
+
+  if (m_BenchmarkLights > 0) {
+    // Dark enough for the lights to show
+    LightGrid* lights = m_Renderer->GetLightGrid();
+    lights->SetEnabled(true);
+    lights->SetAmbient(glm::vec3(0.15f));
+    std::cout << "[Benchmark] " << m_BenchmarkLights << " point lights" << std::endl;
+  }
+
+  if (IsBenchmarking()) {
+    // Measure the renderer, not the display refresh rate
+    SDL_GL_SetSwapInterval(0);
+    std::cout << "[Benchmark] running for " << kBenchmarkDurationSeconds << " seconds"
+              << std::endl;
+  }
+}
+
+void Game::InitTilemap() {
+  // Ground layer of 32 unit tiles centered on the start position
+  const float tileSize = 32.0f;
+  int mapSize = m_BenchmarkTiles;
+  glm::vec2 origin = glm::vec2(400.0f, 300.0f) - glm::vec2(mapSize * tileSize * 0.5f);
+
+  m_Tilemap = new Tilemap(mapSize, mapSize, tileSize, origin);
+  if (!m_Tilemap->Init(m_ResourceManager->GetTexture("tiles"), 16, 16,
+                       m_Renderer->GetBatchShader(ShaderVariant::Textured))) {
+    delete m_Tilemap;
+    m_Tilemap = nullptr;
+    return;
+  }
+
+  // Tileset cells: 1 grass, 2 dirt, 3 stone, 4 water. Hashed patches so
+  // neighbouring chunks differ
+  int ground = m_Tilemap->AddLayer();
+  for (int y = 0; y < mapSize; y++) {
+    for (int x = 0; x < mapSize; x++) {
+      unsigned int hash = (unsigned int)((x / 4) * 73856093) ^ (unsigned int)((y / 4) * 19349663);
+      uint16_t tile = 1;
+      switch (hash % 16) {
+      case 0: tile = 4; break;
+      case 1: case 2: tile = 2; break;
+      case 3: tile = 3; break;
+      default: break;
+      }
+      m_Tilemap->SetTile(ground, x, y, tile);
+    }
+  }
+  std::cout << "[Benchmark] " << mapSize << "x" << mapSize << " tilemap ("
+            << (mapSize * mapSize) << " tiles)" << std::endl;
+}
+
+void Game::InitParticles() {
+  // Fountains around the start position; live count settles at
+  // rate * average lifetime per emitter
+  const float averageLifetime = 2.0f;
+  int perEmitterLimit = ParticleEmitter::kMaxCapacity * 3 / 4;
+  int emitterCount = std::max(4, (m_BenchmarkParticles + perEmitterLimit - 1) / perEmitterLimit);
+  int perEmitter = m_BenchmarkParticles / emitterCount;
+
+  for (int i = 0; i < emitterCount; i++) {
+    float angle = 6.2831853f * i / emitterCount;
+    EmitterSettings settings;
+    settings.position = glm::vec2(400.0f, 300.0f) + glm::vec2(std::cos(angle), std::sin(angle)) * 250.0f;
+    settings.rate = perEmitter / averageLifetime;
+    settings.minLifetime = averageLifetime - 0.5f;
+    settings.maxLifetime = averageLifetime + 0.5f;
+    settings.minSpeed = 100.0f;
+    settings.maxSpeed = 250.0f;
+    settings.direction = -1.5707963f;  // up
+    settings.spread = 1.0f;
+    settings.gravity = glm::vec2(0.0f, 200.0f);
+    settings.minSize = 2.0f;
+    settings.maxSize = 5.0f;
+    settings.minColor = glm::vec4(0.9f, 0.3f, 0.0f, 1.0f);
+    settings.maxColor = glm::vec4(1.0f, 0.8f, 0.2f, 1.0f);
+    // Headroom over the steady state for spawn jitter
+    m_Particles->AddEmitter(settings, perEmitter + perEmitter / 4);
+  }
+  std::cout << "[Benchmark] " << m_BenchmarkParticles << " particles in " << emitterCount
+            << " emitters" << std::endl;
 }
 
 void Game::HandleEvents() {
@@ -193,11 +385,19 @@ void Game::HandleEvents() {
     case SDL_QUIT:
       isRunning = false;
       break;
+    case SDL_WINDOWEVENT:
+      // Exposed, resized or restored windows may have lost their contents
+      m_Dirty = true;
+      break;
     case SDL_KEYDOWN:
+      if (event.key.keysym.sym == SDLK_F1) {
+        m_ShowDebugOverlay = !m_ShowDebugOverlay;
+        m_Dirty = true;
+      }
       if (event.key.keysym.sym == SDLK_w) {
         // Play jump sound effect
         if (m_ResourceManager) {
-          m_ResourceManager->PlaySound("jump");
+          m_ResourceManager->PlaySound(m_JumpSound);
         }
       }
       break;
@@ -220,21 +420,45 @@ void Game::Update(float deltaTime) {
   
   // Update player movement with collision detection
   bool wasColliding = m_WasColliding;
+  uint32_t revision = m_Scene->GetRevision();
   m_Scene->UpdatePlayerMovement(movement, speed, deltaTime, m_WasColliding);
+  // Idle skipping relies on an idle scene keeping its revision
+  assert(movement != glm::vec2(0.0f) || m_Scene->GetRevision() == revision);
+  (void)revision;
   
   // Update player animation
   if (m_Scene->GetGameObjectCount() > 0) {
     GameObject* player = m_Scene->GetGameObject(0);
     if (player) {
+      Animation* animation = player->currentAnimation;
+      int frame = animation ? animation->GetCurrentFrameIndex() : 0;
       player->Update(deltaTime);
+      if (animation && animation->GetCurrentFrameIndex() != frame) {
+        m_Dirty = true;
+      }
     }
   }
   
   // Play collision sound if collision just started
   if (m_WasColliding && !wasColliding && m_ResourceManager) {
-    m_ResourceManager->PlaySound("collision");
+    m_ResourceManager->PlaySound(m_CollisionSound);
   }
   
+  if (m_Particles) {
+    m_Particles->Update(deltaTime, m_ThreadPool);
+  }
+
+  SubmitLights(deltaTime);
+
+  if (m_Renderer) {
+    m_Renderer->GetAnimationClips()->Advance(deltaTime);
+  }
+
+  // Swapping in a streamed texture changes what objects using it show
+  if (m_ResourceManager->UpdateTextureUploads(kTextureUploadBudgetMs) > 0) {
+    m_Dirty = true;
+  }
+
   // Camera follows player
   if (m_Camera && m_Scene->GetGameObjectCount() > 0) {
     GameObject* player = m_Scene->GetGameObject(0);
@@ -244,53 +468,348 @@ void Game::Update(float deltaTime) {
   }
 }
 
+void Game::SubmitLights(float deltaTime) {
+  LightGrid* lights = m_Renderer ? m_Renderer->GetLightGrid() : nullptr;
+  if (!lights || !lights->IsEnabled()) {
+    return;
+  }
+  m_LightTime += deltaTime;
+
+  // The player carries a torch
+  GameObject* player = m_Scene->GetGameObject(0);
+  if (player) {
+    lights->AddLight(player->position, 160.0f, glm::vec3(1.0f, 0.85f, 0.6f), 1.2f);
+  }
+
+  // Benchmark lights circle around the cells of a grid centered on the start
+  // position, each with its own phase and hue
+  int columns = (int)std::ceil(std::sqrt((float)m_BenchmarkLights));
+  for (int i = 0; i < m_BenchmarkLights; i++) {
+    glm::vec2 cell((float)(i % columns), (float)(i / columns));
+    glm::vec2 center = glm::vec2(400.0f, 300.0f) + (cell - (columns - 1) * 0.5f) * 96.0f;
+    float phase = i * 2.3999632f;
+    float angle = m_LightTime * 1.5f + phase;
+    glm::vec3 color(0.5f + 0.5f * std::cos(phase), 0.5f + 0.5f * std::cos(phase + 2.0943951f),
+                    0.5f + 0.5f * std::cos(phase + 4.1887902f));
+    lights->AddLight(center + glm::vec2(std::cos(angle), std::sin(angle)) * 32.0f, 80.0f, color,
+                     1.5f);
+  }
+}
+
+bool Game::NeedsRender() const {
+  if (!m_IdleSkip || m_Dirty || IsBenchmarking() || m_FrameCapture) {
+    return true;
+  }
+  // Continuously changing content
+  if ((m_Particles && m_Particles->GetLiveCount() > 0) ||
+      m_Renderer->GetAnimationClips()->HasClips()) {
+    return true;
+  }
+  return m_Scene->GetRevision() != m_DrawnSceneRevision ||
+         m_Camera->position != m_DrawnCameraPosition || m_ScoreText != m_DrawnScoreText;
+}
+
+void Game::WaitForActivity() {
+  if (!m_Renderer || !m_Camera || !m_Scene || NeedsRender()) {
+    return;
+  }
+  // Held movement keys send no further events, so keep polling them; decode
+  // workers finishing don't send any either
+  if ((m_InputManager && m_InputManager->GetMovementInput() != glm::vec2(0.0f)) ||
+      (m_ResourceManager && m_ResourceManager->IsStreamingTextures())) {
+    return;
+  }
+  int timeoutMs = kMaxIdleWaitMs;
+  // Wake in time for the player's next animation frame
+  GameObject* player = m_Scene->GetGameObject(0);
+  if (player && player->currentAnimation) {
+    float seconds = player->currentAnimation->GetTimeToNextFrame();
+    if (seconds >= 0.0f) {
+      timeoutMs = std::min(timeoutMs, (int)std::ceil(seconds * 1000.0f));
+    }
+  }
+  // A null event leaves it queued for HandleEvents
+  SDL_WaitEventTimeout(nullptr, timeoutMs);
+}
+
 void Game::Render() {
   if (!m_Renderer || !m_Camera || !m_Scene) {
     return;
   }
+  // The back buffer still holds an identical frame; skip the draw and swap
+  if (!NeedsRender()) {
+    return;
+  }
+  m_Dirty = false;
+  m_DrawnSceneRevision = m_Scene->GetRevision();
+  m_DrawnCameraPosition = m_Camera->position;
+  m_DrawnScoreText = m_ScoreText;
+
+  m_Renderer->BeginFrame();
+  RenderStats* stats = m_Renderer->GetStats();
+
+  // Upload view and projection matrices from camera once per frame
+  m_Renderer->UpdateCamera(*m_Camera, m_ScreenWidth, m_ScreenHeight);
+
+  // Static layers re-render offscreen only when invalidated or when the view
+  // leaves their cached region; this must happen before the frame's target
+  // is bound
+  UpdateLayerCaches(m_Camera->GetViewRect());
+
+  if (m_DynamicResolution) {
+    // GPU time is not padded by vsync waits, so it shows the headroom the
+    // frame time hides; it lags RenderStats::kQueryLatency frames
+    const FrameStats& resolved = stats->GetResolvedFrame();
+    double gpuMs = 0.0;
+    bool timed = false;
+    for (int pass = 0; pass < stats->GetPassCount(); pass++) {
+      if (resolved.gpuPassMs[pass] >= 0.0) {
+        gpuMs += resolved.gpuPassMs[pass];
+        timed = true;
+      }
+    }
+    m_DynamicResolution->Update(timed ? gpuMs : resolved.cpuFrameMs);
+    m_DynamicResolution->Begin();
+  }
 
   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT);
+  m_Renderer->UseCameraSpace(CameraSpace::World);
 
-  // Get view and projection matrices from camera
-  glm::mat4 view = m_Camera->GetViewMatrix();
-  glm::mat4 projection = m_Camera->GetProjectionMatrix(m_ScreenWidth, m_ScreenHeight);
+  SpriteBatch* batch = m_Renderer->GetSpriteBatch();
 
-  GLuint shaderProgram = m_Renderer->GetShaderProgram();
-  GLuint VAO = m_Renderer->GetVAO();
-  GLuint circleVAO = m_Renderer->GetCircleVAO();
-  int circleIndexCount = m_Renderer->GetCircleIndexCount();
+  // Level geometry first: only tile chunks overlapping the view are drawn
+  glm::vec4 viewRect = m_Camera->GetViewRect();
+  if (m_Tilemap) {
+    stats->BeginPass("tiles");
+    m_Tilemap->Draw(viewRect);
+    stats->EndPass();
+  }
 
-  // Draw all GameObjects
-  for (size_t i = 0; i < m_Scene->GetGameObjectCount(); i++) {
-    GameObject* obj = m_Scene->GetGameObject(i);
-    if (!obj) continue;
-    
-    if (i == 0) {
-      // Player object - use texture
-      obj->Draw(view, projection, shaderProgram, VAO, 6, false);
-    } else if (i == 1) {
-      // Reference point - use red color and circle VAO
-      obj->Draw(view, projection, shaderProgram, circleVAO, circleIndexCount, 
-                true, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
-    } else if (i == 2) {
-      // Wall object - use blue color
-      obj->Draw(view, projection, shaderProgram, VAO, 6, 
-                true, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
-    } else {
-      // Other objects - default rendering
-      obj->Draw(view, projection, shaderProgram, VAO, 6, false);
+  // Record only GameObjects near the view. Large scenes are split into
+  // contiguous chunks recorded in parallel into per-chunk command lists; the
+  // render queue merges them in chunk order, sorts by layer, Y and state and
+  // the batch merges them into as few draws as it can. Objects on cached
+  // layers are skipped; the render queue draws their layer image instead
+  const std::vector<uint32_t>& visible = m_Scene->Cull(viewRect);
+  size_t chunkCount = std::min((size_t)m_ThreadPool->GetThreadCount() + 1,
+                               (visible.size() + kObjectsPerRecordChunk - 1) / kObjectsPerRecordChunk);
+  m_Renderer->PrepareCommandLists(chunkCount);
+  m_ThreadPool->ParallelFor(visible.size(), chunkCount,
+                            [this, &visible](size_t chunk, size_t begin, size_t end) {
+    RenderQueue* list = m_Renderer->GetCommandList(chunk);
+    for (size_t i = begin; i < end; i++) {
+      GameObject* obj = m_Scene->GetGameObject(visible[i]);
+      if (obj && !m_LayerCaches[(int)obj->layer]) {
+        obj->Draw(*list, *m_ResourceManager);
+      }
     }
+  });
+  stats->BeginPass("world");
+  m_Renderer->DrawQueue();
+  stats->EndPass();
+
+#ifdef LEO_DEBUG_DRAW
+  if (m_ShowDebugOverlay) {
+    DrawDebugOverlay(visible, viewRect);
+  }
+#endif
+
+  // Particles on top of the world, one draw per emitter
+  if (m_Particles && m_Particles->GetLiveCount() > 0) {
+    stats->BeginPass("particles");
+    m_Particles->Draw(*batch, *m_Renderer->GetVertexStream(), m_ThreadPool);
+    stats->EndPass();
+  }
+
+  // Upscale the world to the window before drawing UI at native resolution
+  if (m_DynamicResolution) {
+    m_DynamicResolution->End();
+    m_Renderer->UseCameraSpace(CameraSpace::Screen);
+    stats->BeginPass("upscale");
+    m_DynamicResolution->Composite(*batch);
+    stats->EndPass();
   }
 
   // Render text in screen space (UI elements)
   if (m_ResourceManager && m_ResourceManager->GetTextRenderer()) {
-    m_ResourceManager->GetTextRenderer()->RenderText("SCORE: 100", 100, 20, 
-                                                      shaderProgram, VAO, 
-                                                      m_ScreenWidth, m_ScreenHeight);
+    // Screen space projection (no view matrix, fixed orthographic)
+    m_Renderer->UseCameraSpace(CameraSpace::Screen);
+    stats->BeginPass("ui");
+    batch->Begin();
+    m_ResourceManager->GetTextRenderer()->RenderText(m_ScoreText, 100, 20, *batch);
+    batch->End();
+    stats->EndPass();
+  }
+
+#ifdef LEO_DEBUG_DRAW
+  // Everything queued through DebugDraw this frame, over the UI
+  m_Renderer->UseCameraSpace(CameraSpace::WorldUnlit);
+  stats->BeginPass("debug");
+  m_Renderer->GetDebugDraw()->Flush();
+  stats->EndPass();
+#endif
+
+  // Reads back the finished frame asynchronously, before the swap leaves
+  // the back buffer undefined
+  if (m_FrameCapture) {
+    m_FrameCapture->Capture();
   }
 
   SDL_GL_SwapWindow(window);
+  m_Renderer->EndFrame();
+
+  if (IsBenchmarking()) {
+    UpdateBenchmark();
+  }
+}
+
+void Game::UpdateBenchmark() {
+  Uint64 now = SDL_GetPerformanceCounter();
+  if (m_BenchLastCounter == 0) {
+    m_BenchLastCounter = now;
+    m_BenchStartCounter = now;
+    return;
+  }
+
+  double frameMs = (now - m_BenchLastCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+  m_BenchLastCounter = now;
+  m_BenchFrames++;
+  m_BenchFrameTimeMs += frameMs;
+  m_BenchWorstFrameMs = std::max(m_BenchWorstFrameMs, frameMs);
+  m_BenchTotalFrames++;
+  m_BenchTotalFrameTimeMs += frameMs;
+
+  SpriteBatch* batch = m_Renderer->GetSpriteBatch();
+  GLStateCache* state = m_Renderer->GetStateCache();
+
+  // Report once per second
+  if (m_BenchFrameTimeMs >= 1000.0) {
+    int cacheRebuilds = 0;
+    for (LayerCache* cache : m_LayerCaches) {
+      cacheRebuilds += cache ? cache->GetRebuildCount() : 0;
+    }
+    std::cout << "[Benchmark] " << (batch->GetMode() == SpriteBatchMode::Instanced ? "instanced" : "vertices")
+              << " objects visible/culled: " << m_Scene->GetVisibleCount()
+              << "/" << m_Scene->GetCulledCount()
+              << " sprites: " << batch->GetSpriteCount()
+              << " tile chunks drawn: " << (m_Tilemap ? m_Tilemap->GetDrawnChunkCount() : 0)
+              << " particles: " << m_Particles->GetLiveCount()
+              << " (update " << m_Particles->GetUpdateMs() << " ms)"
+              << " layer cache rebuilds: " << cacheRebuilds
+              << " lights visible/max per tile: " << m_Renderer->GetLightGrid()->GetVisibleLightCount()
+              << "/" << m_Renderer->GetLightGrid()->GetMaxTileLightCount()
+              << " textures streaming: " << m_ResourceManager->GetStreamingTextureCount()
+              << " capture: " << (m_FrameCapture ? m_FrameCapture->GetLastCaptureMs() : 0.0) << " ms"
+              << " render scale: " << (m_DynamicResolution ? m_DynamicResolution->GetScale() : 1.0f)
+              << " draw calls: " << batch->GetDrawCallCount()
+              << " state calls issued/skipped: " << state->GetIssuedCount()
+              << "/" << state->GetSkippedCount()
+              << " avg frame: " << (m_BenchFrameTimeMs / m_BenchFrames) << " ms"
+              << " (" << (m_BenchFrames * 1000.0 / m_BenchFrameTimeMs) << " fps)"
+              << " worst frame: " << m_BenchWorstFrameMs << " ms"
+              << std::endl;
+    m_BenchFrames = 0;
+    m_BenchFrameTimeMs = 0.0;
+    m_BenchWorstFrameMs = 0.0;
+  }
+
+  double elapsedSeconds = (now - m_BenchStartCounter) / (double)SDL_GetPerformanceFrequency();
+  if (elapsedSeconds >= kBenchmarkDurationSeconds) {
+    std::cout << "[Benchmark] finished: " << m_BenchTotalFrames << " frames, avg frame: "
+              << (m_BenchTotalFrameTimeMs / m_BenchTotalFrames) << " ms, draw calls: "
+              << batch->GetDrawCallCount() << std::endl;
+    isRunning = false;
+  }
+}
+
+void Game::UpdateLayerCaches(const glm::vec4& viewRect) {
+  RenderStats* stats = m_Renderer->GetStats();
+  for (int i = 0; i < kRenderLayerCount; i++) {
+    RenderLayer layer = (RenderLayer)i;
+    LayerCache*& cache = m_LayerCaches[i];
+    if (!m_UseLayerCache || !m_Scene->IsLayerStatic(layer)) {
+      if (cache) {
+        cache->Cleanup();
+        delete cache;
+        cache = nullptr;
+      }
+      continue;
+    }
+
+    if (!cache) {
+      cache = new LayerCache();
+      if (!cache->Init(m_ScreenWidth, m_ScreenHeight)) {
+        // Draw the layer every frame instead
+        delete cache;
+        cache = nullptr;
+        continue;
+      }
+    }
+
+    uint32_t revision = m_Scene->GetLayerRevision(layer);
+    if (cache->IsValid(viewRect, revision)) {
+      continue;
+    }
+
+    stats->BeginPass("layer cache");
+    cache->BeginRebuild(viewRect, revision);
+    m_Renderer->UpdateRegionCamera(cache->GetRegion());
+    m_Renderer->UseCameraSpace(CameraSpace::Region);
+    RenderQueue* queue = m_Renderer->GetRenderQueue();
+    for (uint32_t index : m_Scene->Cull(cache->GetRegion())) {
+      GameObject* obj = m_Scene->GetGameObject(index);
+      if (obj && obj->layer == layer) {
+        obj->Draw(*queue, *m_ResourceManager);
+      }
+    }
+    m_Renderer->DrawQueue();
+    cache->EndRebuild();
+    stats->EndPass();
+  }
+
+  // Registered only after every rebuild, since DrawQueue consumes them
+  for (int i = 0; i < kRenderLayerCount; i++) {
+    if (m_LayerCaches[i]) {
+      m_Renderer->SetLayerImage((RenderLayer)i, m_LayerCaches[i]->GetTexture(),
+                                m_LayerCaches[i]->GetRegion());
+    }
+  }
+}
+
+void Game::DrawDebugOverlay(const std::vector<uint32_t>& visible, const glm::vec4& viewRect) {
+  // Spatial grid cells around the view
+  float cellSize = m_Scene->GetGrid().GetCellSize();
+  const glm::vec4 gridColor(0.5f, 0.5f, 0.5f, 0.6f);
+  float firstX = std::floor(viewRect.x / cellSize) * cellSize;
+  float firstY = std::floor(viewRect.y / cellSize) * cellSize;
+  for (float x = firstX; x <= viewRect.z; x += cellSize) {
+    DebugDraw::Line(glm::vec2(x, viewRect.y), glm::vec2(x, viewRect.w), gridColor);
+  }
+  for (float y = firstY; y <= viewRect.w; y += cellSize) {
+    DebugDraw::Line(glm::vec2(viewRect.x, y), glm::vec2(viewRect.z, y), gridColor);
+  }
+
+  // Collision boxes of the visible objects; the player's turns red while
+  // it is touching something
+  GameObject* player = m_Scene->GetGameObject(0);
+  for (uint32_t index : visible) {
+    GameObject* obj = m_Scene->GetGameObject(index);
+    if (!obj) {
+      continue;
+    }
+    bool hit = obj == player && m_WasColliding;
+    DebugDraw::Rect(obj->GetBoundingBox(), hit ? glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)
+                                               : glm::vec4(0.0f, 0.8f, 0.0f, 1.0f));
+  }
+
+  if (player) {
+    std::string label = "VISIBLE " + std::to_string(visible.size()) + "/" +
+                        std::to_string(m_Scene->GetGameObjectCount());
+    glm::vec4 box = player->GetBoundingBox();
+    DebugDraw::Text(glm::vec2(box.x - box.z * 0.5f, box.y - box.w * 0.5f - 14.0f),
+                    label.c_str(), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+  }
 }
 
 void Game::Clean() {
@@ -307,6 +826,49 @@ void Game::Clean() {
     m_Camera = nullptr;
   }
 
+  // Clean up particle pools
+  if (m_Particles) {
+    m_Particles->Cleanup();
+    delete m_Particles;
+    m_Particles = nullptr;
+  }
+
+  // Clean up static layer images
+  for (LayerCache*& cache : m_LayerCaches) {
+    if (cache) {
+      cache->Cleanup();
+      delete cache;
+      cache = nullptr;
+    }
+  }
+
+  // Writes out the frames still in flight
+  if (m_FrameCapture) {
+    m_FrameCapture->Cleanup();
+    delete m_FrameCapture;
+    m_FrameCapture = nullptr;
+  }
+
+  // Clean up the offscreen target
+  if (m_DynamicResolution) {
+    m_DynamicResolution->Cleanup();
+    delete m_DynamicResolution;
+    m_DynamicResolution = nullptr;
+  }
+
+  // Clean up Tilemap (chunk buffers)
+  if (m_Tilemap) {
+    m_Tilemap->Cleanup();
+    delete m_Tilemap;
+    m_Tilemap = nullptr;
+  }
+
+  // Clean up worker threads
+  if (m_ThreadPool) {
+    delete m_ThreadPool;
+    m_ThreadPool = nullptr;
+  }
+
   // Clean up ResourceManager (textures, sounds, fonts)
   if (m_ResourceManager) {
     m_ResourceManager->Cleanup();
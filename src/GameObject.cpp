@@ -1,66 +1,74 @@
 #include "GameObject.h"
 #include "Animation.h"
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
+#include "RenderStats.h"
+#include "ResourceManager.h"
 
-GameObject::GameObject(glm::vec2 position, glm::vec2 size, Texture* texture)
-    : position(position), size(size), texture(texture), currentAnimation(nullptr) {}
+GameObject::GameObject(glm::vec2 position, glm::vec2 size, TextureHandle texture)
+    : position(position), size(size), texture(texture), currentAnimation(nullptr),
+      animationClip(-1), animationStart(0.0f),
+      layer(RenderLayer::World), shape(SpriteShape::Quad), shapeParameter(0.0f),
+      useColor(false), color(1.0f) {}
 
 GameObject::~GameObject() {}
 
 void GameObject::Update(float deltaTime) {
-  if (currentAnimation) {
+  // GPU clips advance with the shared clock, nothing to do per object
+  if (currentAnimation && animationClip < 0) {
     currentAnimation->Update(deltaTime);
   }
 }
 
-void GameObject::Draw(const glm::mat4& view, const glm::mat4& projection,
-                      GLuint shaderProgram, GLuint VAO, int indexCount,
-                      bool useColor, glm::vec4 color) {
-  // Use shader program
-  glUseProgram(shaderProgram);
-
-  // Create model matrix
-  glm::mat4 model = glm::mat4(1.0f);
-  model = glm::translate(model, glm::vec3(position.x, position.y, 0.0f));
-  model = glm::scale(model, glm::vec3(size.x, size.y, 1.0f));
+void GameObject::Draw(RenderQueue& queue, const ResourceManager& resources) const {
+  const Texture* sheet = resources.GetTexture(texture);
+  if (!texture.IsNull() && !sheet && !useColor && shape == SpriteShape::Quad) {
+    // The texture was unloaded; draw nothing rather than a white quad
+    return;
+  }
+  if (RenderStats* stats = RenderStats::Get()) {
+    stats->AddObjectDrawn();
+  }
 
-  // Set uniforms
-  unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
-  glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+  // Top-down sorting by the bottom edge, so objects lower on screen overlap
+  // the ones above them
+  float depth = position.y + size.y * 0.5f;
+  bool solid = useColor || !sheet;
+  // Sprite textures carry alpha; solid shapes only blend when faded
+  bool translucent = !solid || color.a < 1.0f;
 
-  unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
-  glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+  if (shape != SpriteShape::Quad) {
+    // Antialiased edges always blend
+    queue.SubmitShape(layer, true, depth, shape, position, size, color, shapeParameter);
+    return;
+  }
 
-  unsigned int projLoc = glGetUniformLocation(shaderProgram, "projection");
-  glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+  if (solid) {
+    // Texture 0 draws with the solid color shader variant
+    queue.SubmitQuad(layer, translucent, depth, 0, position, size,
+                     glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), color);
+    return;
+  }
 
-  // Set color or texture
-  unsigned int useColorLoc = glGetUniformLocation(shaderProgram, "useColor");
-  glUniform1i(useColorLoc, useColor ? 1 : 0);
+  if (animationClip >= 0) {
+    // Frame rects are atlas-mapped when the clip is added
+    queue.SubmitQuad(layer, translucent, depth, sheet->GetID(), position, size,
+                     SpriteBatch::AnimationParams(animationClip, animationStart), color);
+    return;
+  }
 
-  if (useColor) {
-    unsigned int colorLoc = glGetUniformLocation(shaderProgram, "color");
-    glUniform4f(colorLoc, color.r, color.g, color.b, color.a);
-    // Set default texture offset/scale for colored objects
-    unsigned int textureOffsetScaleLoc = glGetUniformLocation(shaderProgram, "textureOffsetScale");
-    glUniform4f(textureOffsetScaleLoc, 0.0f, 0.0f, 1.0f, 1.0f);
-  } else if (texture) {
-    texture->Bind();
-    
-    // Set texture offset and scale for animation
-    glm::vec4 textureOffsetScale(0.0f, 0.0f, 1.0f, 1.0f); // Default: full texture
-    if (currentAnimation) {
-      textureOffsetScale = currentAnimation->GetCurrentFrameCoords();
-    }
-    unsigned int textureOffsetScaleLoc = glGetUniformLocation(shaderProgram, "textureOffsetScale");
-    glUniform4f(textureOffsetScaleLoc, textureOffsetScale.x, textureOffsetScale.y, 
-                textureOffsetScale.z, textureOffsetScale.w);
+  // Set texture offset and scale for animation
+  glm::vec4 textureOffsetScale(0.0f, 0.0f, 1.0f, 1.0f); // Default: full texture
+  if (currentAnimation) {
+    textureOffsetScale = currentAnimation->GetCurrentFrameCoords();
   }
+  // Resolve the frame to the texture's atlas page region
+  queue.SubmitQuad(layer, translucent, depth, sheet->GetID(), position, size,
+                   sheet->MapUV(textureOffsetScale), color);
+}
 
-  // Draw
-  glBindVertexArray(VAO);
-  glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+glm::vec4 GameObject::GetDrawBounds() const {
+  // Quads and every SpriteShape fill size, centered on position
+  glm::vec2 halfSize = glm::abs(size) * 0.5f;
+  return glm::vec4(position - halfSize, position + halfSize);
 }
 
 glm::vec4 GameObject::GetBoundingBox() const {
@@ -0,0 +1,89 @@
+#include "LayerCache.h"
+#include "GLStateCache.h"
+#include <cmath>
+#include <iostream>
+
+LayerCache::LayerCache()
+    : m_FBO(0), m_ColorTexture(0), m_ScreenWidth(0), m_ScreenHeight(0), m_Width(0),
+      m_Height(0), m_Region(0.0f), m_Revision(0), m_Valid(false), m_Rebuilds(0) {}
+
+LayerCache::~LayerCache() {
+  Cleanup();
+}
+
+bool LayerCache::Init(int screenWidth, int screenHeight, float paddingFraction) {
+  m_ScreenWidth = screenWidth;
+  m_ScreenHeight = screenHeight;
+  m_Width = (int)std::ceil(screenWidth * (1.0f + 2.0f * paddingFraction));
+  m_Height = (int)std::ceil(screenHeight * (1.0f + 2.0f * paddingFraction));
+  m_Valid = false;
+
+  GLStateCache* state = GLStateCache::Get();
+  glGenTextures(1, &m_ColorTexture);
+  state->BindTexture(m_ColorTexture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               nullptr);
+  // Texels map 1:1 to screen pixels, so sample them as they are
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  glGenFramebuffers(1, &m_FBO);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         m_ColorTexture, 0);
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Layer cache framebuffer incomplete: 0x" << std::hex << status << std::dec
+              << std::endl;
+    Cleanup();
+    return false;
+  }
+  return true;
+}
+
+void LayerCache::Cleanup() {
+  if (m_FBO != 0) {
+    glDeleteFramebuffers(1, &m_FBO);
+    m_FBO = 0;
+  }
+  if (m_ColorTexture != 0) {
+    GLStateCache::Get()->DeleteTexture(m_ColorTexture);
+    m_ColorTexture = 0;
+  }
+  m_Valid = false;
+}
+
+bool LayerCache::IsValid(const glm::vec4& viewRect, uint32_t revision) const {
+  return m_Valid && revision == m_Revision &&
+         viewRect.x >= m_Region.x && viewRect.y >= m_Region.y &&
+         viewRect.z <= m_Region.z && viewRect.w <= m_Region.w;
+}
+
+void LayerCache::BeginRebuild(const glm::vec4& viewRect, uint32_t revision) {
+  // Whole world units at the corner keep texels on the world pixel grid
+  glm::vec2 center(0.5f * (viewRect.x + viewRect.z), 0.5f * (viewRect.y + viewRect.w));
+  glm::vec2 scale(((viewRect.z - viewRect.x) / m_ScreenWidth),
+                  ((viewRect.w - viewRect.y) / m_ScreenHeight));
+  glm::vec2 size = glm::vec2((float)m_Width, (float)m_Height) * scale;
+  glm::vec2 min = glm::floor(center - size * 0.5f);
+  m_Region = glm::vec4(min, min + size);
+  m_Revision = revision;
+  m_Valid = true;
+  m_Rebuilds++;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+  glViewport(0, 0, m_Width, m_Height);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+  // Premultiplied: color blends as usual, alpha accumulates coverage
+  glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void LayerCache::EndRebuild() {
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glViewport(0, 0, m_ScreenWidth, m_ScreenHeight);
+}
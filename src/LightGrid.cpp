@@ -0,0 +1,151 @@
+#include "LightGrid.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+
+LightGrid::LightGrid()
+    : m_Enabled(false), m_Ambient(1.0f), m_MaxTexels(65536), m_LightBuffer(0),
+      m_LightTexture(0), m_TileBuffer(0), m_TileTexture(0), m_Block{}, m_LastLightCount(0),
+      m_LastVisibleCount(0), m_LastMaxTileCount(0) {}
+
+LightGrid::~LightGrid() {
+  Cleanup();
+}
+
+bool LightGrid::Init() {
+  // Both lists are addressed in texels; 65536 is the GL 3.3 minimum
+  glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &m_MaxTexels);
+
+  GLStateCache* state = GLStateCache::Get();
+  const GLuint units[2] = {(GLuint)kLightDataUnit, (GLuint)kLightTilesUnit};
+  const GLenum formats[2] = {GL_RGBA32F, GL_R32UI};
+  GLuint* buffers[2] = {&m_LightBuffer, &m_TileBuffer};
+  GLuint* textures[2] = {&m_LightTexture, &m_TileTexture};
+  for (int i = 0; i < 2; i++) {
+    glGenBuffers(1, buffers[i]);
+    state->BindBuffer(GL_TEXTURE_BUFFER, *buffers[i]);
+    glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+
+    // Buffer textures have their own target, so the units stay free for
+    // 2D textures and these bindings never change
+    glGenTextures(1, textures[i]);
+    state->BindTexture(GL_TEXTURE0 + units[i], GL_TEXTURE_BUFFER, *textures[i]);
+    glTexBuffer(GL_TEXTURE_BUFFER, formats[i], *buffers[i]);
+  }
+  state->ActiveTexture(GL_TEXTURE0);
+  return true;
+}
+
+void LightGrid::Cleanup() {
+  GLStateCache* state = GLStateCache::Get();
+  if (m_LightTexture != 0) {
+    state->DeleteTexture(m_LightTexture);
+    state->DeleteTexture(m_TileTexture);
+    state->DeleteBuffer(m_LightBuffer);
+    state->DeleteBuffer(m_TileBuffer);
+    m_LightTexture = m_TileTexture = 0;
+    m_LightBuffer = m_TileBuffer = 0;
+  }
+  m_Lights.clear();
+}
+
+void LightGrid::AddLight(glm::vec2 position, float radius, glm::vec3 color, float intensity) {
+  if (m_Enabled && radius > 0.0f) {
+    m_Lights.push_back({position, radius, color * intensity});
+  }
+}
+
+void LightGrid::Build(const glm::vec4& viewRect, int screenWidth, int screenHeight) {
+  m_Block = {};
+  m_LastLightCount = (int)m_Lights.size();
+  m_LastVisibleCount = 0;
+  m_LastMaxTileCount = 0;
+  float viewWidth = viewRect.z - viewRect.x;
+  if (!m_Enabled || m_LightTexture == 0 || screenWidth <= 0 || screenHeight <= 0 ||
+      viewWidth <= 0.0f) {
+    m_Lights.clear();
+    return;
+  }
+
+  int columns = (screenWidth + kTileSize - 1) / kTileSize;
+  int rows = (screenHeight + kTileSize - 1) / kTileSize;
+  uint32_t tileCount = (uint32_t)(columns * rows);
+  float tilesPerUnit = screenWidth / (viewWidth * kTileSize);
+  float tileWorldSize = 1.0f / tilesPerUnit;
+  glm::vec2 origin(viewRect.x, viewRect.y);
+
+  // Past the buffer texture limit lights are dropped, never read out of range
+  size_t maxLights = (size_t)m_MaxTexels / 2;
+  size_t maxEntries = (size_t)m_MaxTexels > tileCount + 1 ? (size_t)m_MaxTexels - tileCount - 1 : 0;
+
+  // Bin: one entry per (tile, light) pair the light's circle reaches
+  m_LightData.clear();
+  m_Entries.clear();
+  for (const PointLight& light : m_Lights) {
+    glm::vec2 min = (light.position - light.radius - origin) * tilesPerUnit;
+    glm::vec2 max = (light.position + light.radius - origin) * tilesPerUnit;
+    int minX = std::max(0, (int)std::floor(min.x));
+    int minY = std::max(0, (int)std::floor(min.y));
+    int maxX = std::min(columns - 1, (int)std::floor(max.x));
+    int maxY = std::min(rows - 1, (int)std::floor(max.y));
+    if (minX > maxX || minY > maxY) {
+      continue;
+    }
+    if (m_LightData.size() / 2 >= maxLights) {
+      break;
+    }
+
+    uint32_t index = (uint32_t)(m_LightData.size() / 2);
+    float radiusSquared = light.radius * light.radius;
+    m_LightData.push_back(glm::vec4(light.position, 1.0f / radiusSquared, 0.0f));
+    m_LightData.push_back(glm::vec4(light.color, 0.0f));
+
+    for (int y = minY; y <= maxY; y++) {
+      for (int x = minX; x <= maxX; x++) {
+        // The bounding box also covers tiles near its corners that the
+        // circle misses; test the tile's closest point
+        glm::vec2 tileMin = origin + glm::vec2((float)x, (float)y) * tileWorldSize;
+        glm::vec2 closest = glm::clamp(light.position, tileMin, tileMin + tileWorldSize);
+        glm::vec2 offset = closest - light.position;
+        if (glm::dot(offset, offset) >= radiusSquared || m_Entries.size() >= maxEntries) {
+          continue;
+        }
+        m_Entries.push_back({(uint32_t)(y * columns + x), index});
+      }
+    }
+  }
+  m_LastVisibleCount = (int)(m_LightData.size() / 2);
+  m_Lights.clear();
+
+  // Counting sort by tile: count, turn counts into end offsets, then place
+  // entries backwards so each end walks down to its tile's start
+  m_TileData.assign(tileCount + 1 + m_Entries.size(), 0);
+  for (const TileEntry& entry : m_Entries) {
+    m_TileData[entry.tile]++;
+  }
+  uint32_t end = tileCount + 1;
+  for (uint32_t tile = 0; tile < tileCount; tile++) {
+    m_LastMaxTileCount = std::max(m_LastMaxTileCount, (int)m_TileData[tile]);
+    end += m_TileData[tile];
+    m_TileData[tile] = end;
+  }
+  m_TileData[tileCount] = end;
+  for (size_t i = m_Entries.size(); i-- > 0;) {
+    m_TileData[--m_TileData[m_Entries[i].tile]] = m_Entries[i].light;
+  }
+
+  // Orphan and refill; last frame's draws may still read the old storage
+  GLStateCache* state = GLStateCache::Get();
+  size_t lightBytes = m_LightData.size() * sizeof(glm::vec4);
+  size_t tileBytes = m_TileData.size() * sizeof(uint32_t);
+  state->BindBuffer(GL_TEXTURE_BUFFER, m_LightBuffer);
+  glBufferData(GL_TEXTURE_BUFFER, lightBytes, m_LightData.data(), GL_STREAM_DRAW);
+  state->BindBuffer(GL_TEXTURE_BUFFER, m_TileBuffer);
+  glBufferData(GL_TEXTURE_BUFFER, tileBytes, m_TileData.data(), GL_STREAM_DRAW);
+  RenderStats::Get()->AddStreamedBytes(lightBytes + tileBytes);
+
+  m_Block.grid = glm::vec4(origin, tilesPerUnit, 1.0f);
+  m_Block.gridSize = glm::vec4((float)columns, (float)rows, 0.0f, 0.0f);
+  m_Block.ambient = glm::vec4(m_Ambient, 0.0f);
+}
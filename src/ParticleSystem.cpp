@@ -0,0 +1,231 @@
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLES_SSE2 1
+#endif
+
+ParticleEmitter::ParticleEmitter(const EmitterSettings& settings, int capacity)
+    : m_Settings(settings), m_Capacity(std::max(0, std::min(capacity, kMaxCapacity))),
+      m_Count(0), m_Emitting(true), m_SpawnAccumulator(0.0f), m_RandomState(0x9E3779B9u) {
+  // Pools never grow, so pointers into them stay valid while workers run
+  for (std::vector<float>* array : {&m_PositionX, &m_PositionY, &m_VelocityX, &m_VelocityY,
+                                    &m_Life, &m_InverseLifetime, &m_Size,
+                                    &m_ColorR, &m_ColorG, &m_ColorB, &m_ColorA}) {
+    array->resize(m_Capacity);
+  }
+}
+
+void ParticleEmitter::Update(float deltaTime, ThreadPool* pool) {
+  if (m_Emitting) {
+    m_SpawnAccumulator += m_Settings.rate * deltaTime;
+    int spawnCount = (int)m_SpawnAccumulator;
+    m_SpawnAccumulator -= spawnCount;
+    Spawn(spawnCount);
+  }
+
+  size_t chunkCount = ChunkCount(pool, m_Count);
+  if (chunkCount > 1) {
+    pool->ParallelFor(m_Count, chunkCount,
+                      [this, deltaTime](size_t, size_t begin, size_t end) {
+      Integrate(deltaTime, (int)begin, (int)end);
+    });
+  } else {
+    Integrate(deltaTime, 0, m_Count);
+  }
+
+  Compact();
+}
+
+void ParticleEmitter::Spawn(int count) {
+  count = std::min(count, m_Capacity - m_Count);
+  const EmitterSettings& settings = m_Settings;
+  for (int i = m_Count; i < m_Count + count; i++) {
+    float angle = settings.direction + (Random(0.0f, 1.0f) - 0.5f) * settings.spread;
+    float speed = Random(settings.minSpeed, settings.maxSpeed);
+    float lifetime = std::max(Random(settings.minLifetime, settings.maxLifetime), 0.001f);
+    m_PositionX[i] = settings.position.x;
+    m_PositionY[i] = settings.position.y;
+    m_VelocityX[i] = std::cos(angle) * speed;
+    m_VelocityY[i] = std::sin(angle) * speed;
+    m_Life[i] = lifetime;
+    m_InverseLifetime[i] = 1.0f / lifetime;
+    m_Size[i] = Random(settings.minSize, settings.maxSize);
+    m_ColorR[i] = Random(settings.minColor.r, settings.maxColor.r);
+    m_ColorG[i] = Random(settings.minColor.g, settings.maxColor.g);
+    m_ColorB[i] = Random(settings.minColor.b, settings.maxColor.b);
+    m_ColorA[i] = Random(settings.minColor.a, settings.maxColor.a);
+  }
+  m_Count += count;
+}
+
+void ParticleEmitter::Integrate(float deltaTime, int begin, int end) {
+  float* positionX = m_PositionX.data();
+  float* positionY = m_PositionY.data();
+  float* velocityX = m_VelocityX.data();
+  float* velocityY = m_VelocityY.data();
+  float* life = m_Life.data();
+  float gravityX = m_Settings.gravity.x * deltaTime;
+  float gravityY = m_Settings.gravity.y * deltaTime;
+
+  int i = begin;
+#ifdef PARTICLES_SSE2
+  // Four particles per iteration; slices start anywhere, so loads are
+  // unaligned
+  __m128 dt = _mm_set1_ps(deltaTime);
+  __m128 gx = _mm_set1_ps(gravityX);
+  __m128 gy = _mm_set1_ps(gravityY);
+  for (; i + 4 <= end; i += 4) {
+    __m128 vx = _mm_add_ps(_mm_loadu_ps(velocityX + i), gx);
+    __m128 vy = _mm_add_ps(_mm_loadu_ps(velocityY + i), gy);
+    _mm_storeu_ps(velocityX + i, vx);
+    _mm_storeu_ps(velocityY + i, vy);
+    _mm_storeu_ps(positionX + i, _mm_add_ps(_mm_loadu_ps(positionX + i), _mm_mul_ps(vx, dt)));
+    _mm_storeu_ps(positionY + i, _mm_add_ps(_mm_loadu_ps(positionY + i), _mm_mul_ps(vy, dt)));
+    _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), dt));
+  }
+#endif
+  // Remainder, and the whole range without SSE2; branch free so the
+  // compiler can vectorize it too
+  for (; i < end; i++) {
+    velocityX[i] += gravityX;
+    velocityY[i] += gravityY;
+    positionX[i] += velocityX[i] * deltaTime;
+    positionY[i] += velocityY[i] * deltaTime;
+    life[i] -= deltaTime;
+  }
+}
+
+void ParticleEmitter::Compact() {
+  // Move the last live particle into each dead slot; that particle is
+  // checked again before moving on
+  int i = 0;
+  while (i < m_Count) {
+    if (m_Life[i] > 0.0f) {
+      i++;
+      continue;
+    }
+    int last = --m_Count;
+    m_PositionX[i] = m_PositionX[last];
+    m_PositionY[i] = m_PositionY[last];
+    m_VelocityX[i] = m_VelocityX[last];
+    m_VelocityY[i] = m_VelocityY[last];
+    m_Life[i] = m_Life[last];
+    m_InverseLifetime[i] = m_InverseLifetime[last];
+    m_Size[i] = m_Size[last];
+    m_ColorR[i] = m_ColorR[last];
+    m_ColorG[i] = m_ColorG[last];
+    m_ColorB[i] = m_ColorB[last];
+    m_ColorA[i] = m_ColorA[last];
+  }
+}
+
+void ParticleEmitter::Draw(SpriteBatch& batch, StreamBuffer& vertexStream, ThreadPool* pool) {
+  if (m_Count == 0) {
+    return;
+  }
+
+  // Bounded slices, each taking what the current stream region has left
+  for (int first = 0; first < m_Count;) {
+    int wanted = std::min(m_Count - first, kMaxInstancesPerDraw);
+    GLintptr offset = 0;
+    size_t mappedBytes = 0;
+    SpriteInstance* instances = (SpriteInstance*)vertexStream.Map(
+        sizeof(SpriteInstance), wanted * sizeof(SpriteInstance), sizeof(float), offset,
+        mappedBytes);
+    if (!instances) {
+      return;
+    }
+    int count = (int)(mappedBytes / sizeof(SpriteInstance));
+
+    // The mapping is plain memory, so workers may fill disjoint slices of it
+    size_t chunkCount = ChunkCount(pool, count);
+    if (chunkCount > 1) {
+      pool->ParallelFor(count, chunkCount,
+                        [this, instances, first](size_t, size_t begin, size_t end) {
+        WriteInstances(instances, first, first + (int)begin, first + (int)end);
+      });
+    } else {
+      WriteInstances(instances, first, first, first + count);
+    }
+    vertexStream.Commit(count * sizeof(SpriteInstance));
+
+    batch.DrawInstances(m_Settings.texture, offset, count);
+    first += count;
+  }
+}
+
+void ParticleEmitter::WriteInstances(SpriteInstance* out, int first, int begin,
+                                     int end) const {
+  // Solid particles carry their shape where textured ones carry the rect
+  const glm::vec4 textureOffsetScale = m_Settings.texture != 0
+                                           ? glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)
+                                           : SpriteBatch::ShapeParams(m_Settings.shape);
+  for (int i = begin; i < end; i++) {
+    // Alpha fades linearly to zero over the lifetime
+    float fade = m_Life[i] * m_InverseLifetime[i];
+    SpriteInstance& instance = out[i - first];
+    instance.positionSize = glm::vec4(m_PositionX[i], m_PositionY[i], m_Size[i], m_Size[i]);
+    instance.textureOffsetScale = textureOffsetScale;
+    instance.color = glm::vec4(m_ColorR[i], m_ColorG[i], m_ColorB[i], m_ColorA[i] * fade);
+  }
+}
+
+float ParticleEmitter::Random(float min, float max) {
+  // xorshift32; quality is plenty for spawn jitter
+  m_RandomState ^= m_RandomState << 13;
+  m_RandomState ^= m_RandomState >> 17;
+  m_RandomState ^= m_RandomState << 5;
+  return min + (max - min) * ((m_RandomState >> 8) * (1.0f / 16777216.0f));
+}
+
+size_t ParticleEmitter::ChunkCount(ThreadPool* pool, int count) const {
+  if (!pool) {
+    return 1;
+  }
+  return std::min((size_t)pool->GetThreadCount() + 1, (size_t)count / kParticlesPerChunk);
+}
+
+ParticleSystem::ParticleSystem() : m_UpdateMs(0.0) {}
+
+ParticleSystem::~ParticleSystem() {
+  Cleanup();
+}
+
+ParticleEmitter* ParticleSystem::AddEmitter(const EmitterSettings& settings, int capacity) {
+  ParticleEmitter* emitter = new ParticleEmitter(settings, capacity);
+  m_Emitters.push_back(emitter);
+  return emitter;
+}
+
+void ParticleSystem::Cleanup() {
+  for (ParticleEmitter* emitter : m_Emitters) {
+    delete emitter;
+  }
+  m_Emitters.clear();
+}
+
+void ParticleSystem::Update(float deltaTime, ThreadPool* pool) {
+  auto start = std::chrono::steady_clock::now();
+  for (ParticleEmitter* emitter : m_Emitters) {
+    emitter->Update(deltaTime, pool);
+  }
+  m_UpdateMs = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::Draw(SpriteBatch& batch, StreamBuffer& vertexStream, ThreadPool* pool) {
+  for (ParticleEmitter* emitter : m_Emitters) {
+    emitter->Draw(batch, vertexStream, pool);
+  }
+}
+
+int ParticleSystem::GetLiveCount() const {
+  int count = 0;
+  for (const ParticleEmitter* emitter : m_Emitters) {
+    count += emitter->GetCount();
+  }
+  return count;
+}
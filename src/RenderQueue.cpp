@@ -0,0 +1,122 @@
+#include "RenderQueue.h"
+#include <cstring>
+
+RenderQueue::RenderQueue() {}
+
+uint64_t RenderQueue::MakeKey(RenderLayer layer, bool translucent, uint32_t shader,
+                              GLuint texture, float depth) {
+  uint64_t key = (uint64_t)layer << 56;
+  key |= (uint64_t)DepthBits(depth) << 32;
+  key |= (uint64_t)(translucent ? 1u : 0u) << 31;
+  key |= (uint64_t)(shader & 0x7Fu) << 24;
+  key |= texture & 0xFFFFFFu;
+  return key;
+}
+
+uint32_t RenderQueue::ShaderBits(GLuint texture) {
+  // SpriteBatch starts a new run on a shader variant change; solid shapes of
+  // every kind share the Solid variant
+  return texture == 0 ? 1u : 0u;
+}
+
+uint32_t RenderQueue::DepthBits(float depth) {
+  // Flip floats into an unsigned order (negatives reversed, sign bit set for
+  // positives) and keep the top 24 bits
+  uint32_t bits;
+  std::memcpy(&bits, &depth, sizeof(bits));
+  bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+  return bits >> 8;
+}
+
+void RenderQueue::Submit(const DrawPacket& packet) {
+  m_Entries.push_back({packet.key, (uint32_t)m_Packets.size()});
+  m_Packets.push_back(packet);
+}
+
+void RenderQueue::SubmitQuad(RenderLayer layer, bool translucent, float depth, GLuint texture,
+                             glm::vec2 position, glm::vec2 size,
+                             glm::vec4 uvRect, glm::vec4 color) {
+  uint64_t key = MakeKey(layer, translucent, ShaderBits(texture), texture, depth);
+  Submit({key, texture, position, size, uvRect, color});
+}
+
+void RenderQueue::SubmitShape(RenderLayer layer, bool translucent, float depth,
+                              SpriteShape shape, glm::vec2 position, glm::vec2 size,
+                              glm::vec4 color, float parameter) {
+  SubmitQuad(layer, translucent, depth, 0, position, size,
+             SpriteBatch::ShapeParams(shape, parameter), color);
+}
+
+void RenderQueue::Append(const RenderQueue& other) {
+  uint32_t base = (uint32_t)m_Packets.size();
+  m_Packets.insert(m_Packets.end(), other.m_Packets.begin(), other.m_Packets.end());
+  m_Entries.reserve(m_Entries.size() + other.m_Entries.size());
+  for (const SortEntry& entry : other.m_Entries) {
+    m_Entries.push_back({entry.key, base + entry.index});
+  }
+}
+
+void RenderQueue::Sort() {
+  // LSD radix sort, one byte per pass. Stable, so equal keys keep their
+  // submission order. Passes where every key shares the same byte are
+  // skipped, which is most of them for a typical frame.
+  size_t count = m_Entries.size();
+  m_Scratch.resize(count);
+  SortEntry* source = m_Entries.data();
+  SortEntry* target = m_Scratch.data();
+
+  for (int shift = 0; shift < 64; shift += 8) {
+    size_t histogram[256] = {};
+    for (size_t i = 0; i < count; i++) {
+      histogram[(source[i].key >> shift) & 0xFF]++;
+    }
+    if (histogram[(source[0].key >> shift) & 0xFF] == count) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (size_t& bucket : histogram) {
+      size_t bucketCount = bucket;
+      bucket = offset;
+      offset += bucketCount;
+    }
+    for (size_t i = 0; i < count; i++) {
+      target[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+    }
+    SortEntry* swap = source;
+    source = target;
+    target = swap;
+  }
+
+  if (source != m_Entries.data()) {
+    m_Entries.swap(m_Scratch);
+  }
+}
+
+void RenderQueue::Flush(RenderBackend& backend, const std::function<void(RenderLayer)>& beginLayer) {
+  if (!m_Entries.empty()) {
+    Sort();
+  }
+
+  // Packets at equal depth arrive grouped by texture, so the batch only
+  // breaks runs where the Y order requires it
+  int nextLayer = 0;
+  for (const SortEntry& entry : m_Entries) {
+    int layer = (int)(entry.key >> 56);
+    for (; beginLayer && nextLayer <= layer && nextLayer < kRenderLayerCount; nextLayer++) {
+      beginLayer((RenderLayer)nextLayer);
+    }
+    const DrawPacket& packet = m_Packets[entry.index];
+    backend.SubmitQuad(packet.texture, packet.position, packet.size, packet.uvRect,
+                       packet.color);
+  }
+  for (; beginLayer && nextLayer < kRenderLayerCount; nextLayer++) {
+    beginLayer((RenderLayer)nextLayer);
+  }
+  Clear();
+}
+
+void RenderQueue::Clear() {
+  m_Packets.clear();
+  m_Entries.clear();
+}
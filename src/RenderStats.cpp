@@ -0,0 +1,213 @@
+#include "RenderStats.h"
+#include <cstring>
+#include <iostream>
+
+RenderStats* RenderStats::s_Current = nullptr;
+
+RenderStats::RenderStats()
+    : m_Frames{}, m_Resolved{}, m_HasResolved(false), m_FrameNumber(0), m_ObjectsDrawn(0),
+      m_Queries{}, m_QueryIssued{}, m_PassNames{}, m_PassCount(0), m_ActivePass(-1),
+      m_PrintInterval(0.0), m_CSVHeaderWritten(false) {
+  m_FrameStart = m_LastPrint = std::chrono::steady_clock::now();
+}
+
+void RenderStats::Init() {
+  // GL_TIME_ELAPSED queries are core since 3.3
+  glGenQueries(kQueryLatency * FrameStats::kMaxPasses, &m_Queries[0][0]);
+}
+
+void RenderStats::Cleanup() {
+  if (m_Queries[0][0] != 0) {
+    glDeleteQueries(kQueryLatency * FrameStats::kMaxPasses, &m_Queries[0][0]);
+    std::memset(m_Queries, 0, sizeof(m_Queries));
+  }
+  CloseCSV();
+}
+
+void RenderStats::BeginFrame() {
+  auto now = std::chrono::steady_clock::now();
+  if (m_FrameNumber > 0) {
+    // Frame time is start to start, so it includes the swap
+    m_Frames[(m_FrameNumber - 1) % kQueryLatency].cpuFrameMs =
+        std::chrono::duration<double, std::milli>(now - m_FrameStart).count();
+  }
+  m_FrameStart = now;
+
+  // This slot last held frame N - kQueryLatency; its queries should be done
+  int slot = (int)(m_FrameNumber % kQueryLatency);
+  if (m_FrameNumber >= (uint64_t)kQueryLatency) {
+    Resolve(slot);
+  }
+
+  FrameStats& frame = Current();
+  frame = FrameStats{};
+  frame.frame = m_FrameNumber;
+  for (double& ms : frame.gpuPassMs) {
+    ms = -1.0;
+  }
+  for (bool& issued : m_QueryIssued[slot]) {
+    issued = false;
+  }
+  m_ObjectsDrawn.store(0, std::memory_order_relaxed);
+}
+
+void RenderStats::EndFrame(int stateIssued, int stateSkipped) {
+  if (m_ActivePass >= 0) {
+    EndPass();
+  }
+
+  FrameStats& frame = Current();
+  frame.stateChangesIssued = stateIssued;
+  frame.stateChangesSkipped = stateSkipped;
+  frame.objectsDrawn = m_ObjectsDrawn.load(std::memory_order_relaxed);
+  m_FrameNumber++;
+
+  if (m_PrintInterval > 0.0 && m_HasResolved) {
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - m_LastPrint).count() >= m_PrintInterval) {
+      Print(std::cout);
+      m_LastPrint = now;
+    }
+  }
+}
+
+void RenderStats::BeginPass(const char* name) {
+  if (m_ActivePass >= 0) {
+    EndPass();
+  }
+
+  int pass = 0;
+  while (pass < m_PassCount && std::strcmp(m_PassNames[pass], name) != 0) {
+    pass++;
+  }
+  if (pass == m_PassCount) {
+    if (m_PassCount == FrameStats::kMaxPasses) {
+      return;
+    }
+    m_PassNames[m_PassCount++] = name;
+  }
+
+  int slot = (int)(m_FrameNumber % kQueryLatency);
+  glBeginQuery(GL_TIME_ELAPSED, m_Queries[slot][pass]);
+  m_QueryIssued[slot][pass] = true;
+  m_ActivePass = pass;
+}
+
+void RenderStats::EndPass() {
+  if (m_ActivePass < 0) {
+    return;
+  }
+  glEndQuery(GL_TIME_ELAPSED);
+  m_ActivePass = -1;
+}
+
+void RenderStats::AddDrawCall(int triangles) {
+  FrameStats& frame = Current();
+  frame.drawCalls++;
+  frame.triangles += triangles;
+}
+
+void RenderStats::AddTextureUpload(size_t bytes) {
+  FrameStats& frame = Current();
+  frame.textureUploads++;
+  frame.textureUploadBytes += bytes;
+}
+
+void RenderStats::AddStreamedBytes(size_t bytes) {
+  Current().bytesStreamed += bytes;
+}
+
+void RenderStats::AddGlyphsDrawn(int glyphs) {
+  Current().glyphsDrawn += glyphs;
+}
+
+void RenderStats::Resolve(int slot) {
+  FrameStats& frame = m_Frames[slot];
+  for (int pass = 0; pass < m_PassCount; pass++) {
+    if (!m_QueryIssued[slot][pass]) {
+      continue;
+    }
+    // Never wait: a result that is still pending is reported as missing
+    GLint available = 0;
+    glGetQueryObjectiv(m_Queries[slot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available) {
+      GLuint64 nanoseconds = 0;
+      glGetQueryObjectui64v(m_Queries[slot][pass], GL_QUERY_RESULT, &nanoseconds);
+      frame.gpuPassMs[pass] = nanoseconds / 1.0e6;
+    }
+  }
+
+  m_Resolved = frame;
+  m_HasResolved = true;
+  if (m_CSV.is_open()) {
+    WriteCSVRow(frame);
+  }
+}
+
+void RenderStats::Print(std::ostream& out) const {
+  const FrameStats& frame = m_Resolved;
+  out << "[Stats] frame " << frame.frame << ": " << frame.cpuFrameMs << " ms"
+      << ", draws " << frame.drawCalls << ", tris " << frame.triangles
+      << ", state " << frame.stateChangesIssued << "/" << frame.stateChangesSkipped
+      << " (issued/skipped), tex uploads " << frame.textureUploads
+      << " (" << frame.textureUploadBytes << " B), streamed " << frame.bytesStreamed << " B"
+      << ", objects " << frame.objectsDrawn << ", glyphs " << frame.glyphsDrawn;
+  for (int pass = 0; pass < m_PassCount; pass++) {
+    out << ", gpu " << m_PassNames[pass] << " ";
+    if (frame.gpuPassMs[pass] < 0.0) {
+      out << "-";
+    } else {
+      out << frame.gpuPassMs[pass] << " ms";
+    }
+  }
+  out << std::endl;
+}
+
+bool RenderStats::OpenCSV(const std::string& path) {
+  CloseCSV();
+  m_CSV.open(path, std::ios::out | std::ios::trunc);
+  if (!m_CSV.is_open()) {
+    std::cerr << "Failed to open stats file: " << path << std::endl;
+    return false;
+  }
+  m_CSVHeaderWritten = false;
+  return true;
+}
+
+void RenderStats::CloseCSV() {
+  if (m_CSV.is_open()) {
+    m_CSV.close();
+  }
+}
+
+void RenderStats::WriteCSVRow(const FrameStats& frame) {
+  // Every pass id gets a fixed column, so passes that first run after the
+  // header still line up. The header is written with the first row, once
+  // the passes of a whole frame are known; later slots are named by id.
+  if (!m_CSVHeaderWritten) {
+    m_CSV << "frame,cpu_ms,draw_calls,triangles,state_issued,state_skipped,"
+             "texture_uploads,texture_upload_bytes,bytes_streamed,objects,glyphs";
+    for (int pass = 0; pass < FrameStats::kMaxPasses; pass++) {
+      if (pass < m_PassCount) {
+        m_CSV << ",gpu_" << m_PassNames[pass] << "_ms";
+      } else {
+        m_CSV << ",gpu_pass" << pass << "_ms";
+      }
+    }
+    m_CSV << "\n";
+    m_CSVHeaderWritten = true;
+  }
+
+  m_CSV << frame.frame << "," << frame.cpuFrameMs << "," << frame.drawCalls << ","
+        << frame.triangles << "," << frame.stateChangesIssued << ","
+        << frame.stateChangesSkipped << "," << frame.textureUploads << ","
+        << frame.textureUploadBytes << "," << frame.bytesStreamed << ","
+        << frame.objectsDrawn << "," << frame.glyphsDrawn;
+  for (int pass = 0; pass < FrameStats::kMaxPasses; pass++) {
+    m_CSV << ",";
+    if (pass < m_PassCount && frame.gpuPassMs[pass] >= 0.0) {
+      m_CSV << frame.gpuPassMs[pass];
+    }
+  }
+  m_CSV << "\n";
+}
@@ -3,97 +3,294 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
 #include <cmath>
+#include <cstddef>
 #include <iostream>
 
 Renderer::Renderer()
-    : m_ShaderProgram(0), m_VAO(0), m_VBO(0), m_EBO(0),
-      m_CircleVAO(0), m_CircleVBO(0), m_CircleEBO(0), m_CircleIndexCount(0) {}
+    : m_StateCache(nullptr), m_Stats(nullptr), m_SpriteShaders{nullptr, nullptr}, m_BatchShaders{nullptr, nullptr},
+      m_CameraUBO(0), m_CameraBlockStride(0), m_VAO(0), m_VBO(0), m_EBO(0),
+      m_VertexStream(nullptr), m_IndexStream(nullptr),
+      m_SpriteBatch(nullptr), m_RenderQueue(nullptr), m_LightGrid(nullptr),
+      m_AnimationClips(nullptr), m_ActiveCommandLists(0),
+      m_LayerImages{} {
+#ifdef LEO_DEBUG_DRAW
+  m_DebugDraw = nullptr;
+#endif
+}
 
 Renderer::~Renderer() {
   Cleanup();
 }
 
 bool Renderer::Init() {
+  // Everything below binds through the cache, so it must exist first
+  m_StateCache = new GLStateCache();
+  GLStateCache::SetCurrent(m_StateCache);
+  m_Stats = new RenderStats();
+  m_Stats->Init();
+  RenderStats::SetCurrent(m_Stats);
+
   if (!CompileShaders()) {
     return false;
   }
   CreateQuadBuffers();
-  CreateCircleBuffers();
+  if (!CreateStreamBuffers()) {
+    return false;
+  }
+  CreateCameraBuffer();
+
+  m_SpriteBatch = new SpriteBatch();
+  if (!m_SpriteBatch->Init(m_BatchShaders[(int)ShaderVariant::Textured],
+                           m_BatchShaders[(int)ShaderVariant::Solid],
+                           m_VertexStream, m_IndexStream)) {
+    std::cerr << "Failed to initialize SpriteBatch!" << std::endl;
+    return false;
+  }
+  m_SpriteBatch->InitInstancing(m_SpriteShaders[(int)ShaderVariant::Textured],
+                                m_SpriteShaders[(int)ShaderVariant::Solid],
+                                m_VAO, 6, kMaxInstances);
+  m_SpriteBatch->SetMode(SpriteBatchMode::Instanced);
+
+  m_RenderQueue = new RenderQueue();
+
+  m_LightGrid = new LightGrid();
+  if (!m_LightGrid->Init()) {
+    std::cerr << "Failed to initialize LightGrid!" << std::endl;
+    return false;
+  }
+  m_AnimationClips = new AnimationClips();
+  if (!m_AnimationClips->Init()) {
+    std::cerr << "Failed to initialize AnimationClips!" << std::endl;
+    return false;
+  }
+  m_SpriteBatch->SetAnimationClips(m_AnimationClips);
+
+#ifdef LEO_DEBUG_DRAW
+  m_DebugDraw = new DebugDraw();
+  m_DebugDraw->Init(m_BatchShaders[(int)ShaderVariant::Solid], m_VertexStream);
+  DebugDraw::SetCurrent(m_DebugDraw);
+#endif
   return true;
 }
 
 bool Renderer::CompileShaders() {
+  // Embedded copies of assets/Shaders, used when the files are missing.
+  // Per-object model transform, texture rect and color arrive as instance
+  // attributes, so every sprite sharing a texture goes out in one draw
   const char *vertexShaderSource =
       "#version 330 core\n"
       "layout (location = 0) in vec3 aPos;\n"
       "layout (location = 1) in vec2 aTexCoord;\n"
+      "layout (location = 2) in vec4 aPositionSize;\n"
+      "layout (location = 3) in vec4 aTextureOffsetScale;\n"
+      "layout (location = 4) in vec4 aColor;\n"
       "out vec2 TexCoord;\n"
-      "uniform mat4 model;\n"
-      "uniform mat4 view;\n"
-      "uniform mat4 projection;\n"
-      "uniform vec4 textureOffsetScale;\n"
+      "out vec4 Color;\n"
+      "out vec2 WorldPos;\n"
+      "#ifndef TEXTURED\n"
+      "flat out vec4 Shape;\n"
+      "#endif\n"
+      "layout (std140) uniform Camera {\n"
+      "   mat4 view;\n"
+      "   mat4 projection;\n"
+      "   // Light grid origin (xy), tiles per world unit (z), lit (w); see LightGrid\n"
+      "   vec4 lightGrid;\n"
+      "   vec4 lightGridSize;\n"
+      "   vec4 ambient;\n"
+      "   // Animation clock in seconds (x); see AnimationClips\n"
+      "   vec4 clock;\n"
+      "};\n"
+      "#ifdef TEXTURED\n"
+      "uniform samplerBuffer animationClips;\n"
+      "// Frame rect of an animated sprite's clip at the current clock\n"
+      "vec4 ClipFrame(int clip, float startTime)\n"
+      "{\n"
+      "   vec4 header = texelFetch(animationClips, clip);\n"
+      "   int count = int(header.x);\n"
+      "   int frame = int(max(clock.x - startTime, 0.0) / header.y);\n"
+      "   int loop = int(header.z);\n"
+      "   if (loop == 0) {\n"
+      "      frame = frame % count;\n"
+      "   } else if (loop == 1) {\n"
+      "      frame = min(frame, count - 1);\n"
+      "   } else {\n"
+      "      // Ping-pong runs forward, then back without repeating the ends\n"
+      "      int period = max(2 * count - 2, 1);\n"
+      "      frame = frame % period;\n"
+      "      frame = frame < count ? frame : period - frame;\n"
+      "   }\n"
+      "   return texelFetch(animationClips, clip + 1 + frame);\n"
+      "}\n"
+      "#endif\n"
       "void main()\n"
       "{\n"
-      "   gl_Position = projection * view * model * vec4(aPos, 1.0);\n"
-      "   TexCoord = (aTexCoord * textureOffsetScale.zw) + textureOffsetScale.xy;\n"
-      "}\0";
+      "   vec2 worldPos = aPos.xy * aPositionSize.zw + aPositionSize.xy;\n"
+      "   gl_Position = projection * view * vec4(worldPos, aPos.z, 1.0);\n"
+      "   WorldPos = worldPos;\n"
+      "#ifdef TEXTURED\n"
+      "   vec4 frameRect = aTextureOffsetScale;\n"
+      "   // A zero-size rect marks an animated sprite: clip id (x), start time (y)\n"
+      "   if (frameRect.z == 0.0 && frameRect.w == 0.0) {\n"
+      "      frameRect = ClipFrame(int(frameRect.x), frameRect.y);\n"
+      "   }\n"
+      "   TexCoord = (aTexCoord * frameRect.zw) + frameRect.xy;\n"
+      "#else\n"
+      "   // Solid sprites carry shape kind and parameter instead of a texture rect\n"
+      "   TexCoord = aPos.xy * aPositionSize.zw;\n"
+      "   Shape = vec4(abs(aPositionSize.zw) * 0.5, aTextureOffsetScale.xy);\n"
+      "#endif\n"
+      "   Color = aColor;\n"
+      "}\n";
+  // Shared by the sprite and batch programs; TEXTURED is defined for the
+  // textured variant only
   const char *fragmentShaderSource =
       "#version 330 core\n"
       "out vec4 FragColor;\n"
       "in vec2 TexCoord;\n"
+      "in vec4 Color;\n"
+      "in vec2 WorldPos;\n"
+      "layout (std140) uniform Camera {\n"
+      "   mat4 view;\n"
+      "   mat4 projection;\n"
+      "   // Light grid origin (xy), tiles per world unit (z), lit (w); see LightGrid\n"
+      "   vec4 lightGrid;\n"
+      "   vec4 lightGridSize;\n"
+      "   vec4 ambient;\n"
+      "   // Animation clock in seconds (x); see AnimationClips\n"
+      "   vec4 clock;\n"
+      "};\n"
+      "// Lights binned into screen tiles by LightGrid: two texels per light, and\n"
+      "// per-tile start offsets followed by the light indices\n"
+      "uniform samplerBuffer lightData;\n"
+      "uniform usamplerBuffer lightIndices;\n"
+      "vec3 Lighting(vec2 p)\n"
+      "{\n"
+      "   ivec2 tile = ivec2(floor((p - lightGrid.xy) * lightGrid.z));\n"
+      "   ivec2 size = ivec2(lightGridSize.xy);\n"
+      "   if (any(lessThan(tile, ivec2(0))) || any(greaterThanEqual(tile, size))) {\n"
+      "      return ambient.rgb;\n"
+      "   }\n"
+      "   int t = tile.y * size.x + tile.x;\n"
+      "   int first = int(texelFetch(lightIndices, t).r);\n"
+      "   int last = int(texelFetch(lightIndices, t + 1).r);\n"
+      "   vec3 light = ambient.rgb;\n"
+      "   for (int i = first; i < last; i++) {\n"
+      "      int index = int(texelFetch(lightIndices, i).r);\n"
+      "      vec4 positionFalloff = texelFetch(lightData, 2 * index);\n"
+      "      vec2 d = p - positionFalloff.xy;\n"
+      "      // Smooth falloff, zero at the radius\n"
+      "      float f = clamp(1.0 - dot(d, d) * positionFalloff.z, 0.0, 1.0);\n"
+      "      light += texelFetch(lightData, 2 * index + 1).rgb * (f * f);\n"
+      "   }\n"
+      "   return light;\n"
+      "}\n"
+      "#ifdef TEXTURED\n"
       "uniform sampler2D tex;\n"
-      "uniform vec4 color;\n"
-      "uniform bool useColor;\n"
+      "#else\n"
+      "// Half size (xy), kind (z), parameter (w); TexCoord is the offset from the\n"
+      "// quad center in the same units\n"
+      "flat in vec4 Shape;\n"
+      "float ShapeDistance(vec2 p)\n"
+      "{\n"
+      "   vec2 halfSize = Shape.xy;\n"
+      "   float shortHalf = min(halfSize.x, halfSize.y);\n"
+      "   int kind = int(Shape.z + 0.5);\n"
+      "   if (kind <= 2) {\n"
+      "      // Ellipse, approximated by scaling a circle of the short radius\n"
+      "      float d = (length(p / max(halfSize, 1e-4)) - 1.0) * shortHalf;\n"
+      "      // Ring: band of the given thickness inside the outline\n"
+      "      return kind == 2 ? abs(d + Shape.w * 0.5) - Shape.w * 0.5 : d;\n"
+      "   }\n"
+      "   // Rounded rectangle; a capsule rounds by half the short side\n"
+      "   float radius = kind == 4 ? shortHalf : clamp(Shape.w, 0.0, shortHalf);\n"
+      "   vec2 q = abs(p) - halfSize + radius;\n"
+      "   return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;\n"
+      "}\n"
+      "#endif\n"
       "void main()\n"
       "{\n"
-      "   if (useColor) {\n"
-      "       FragColor = color;\n"
-      "   } else {\n"
-      "       FragColor = texture(tex, TexCoord);\n"
+      "#ifdef TEXTURED\n"
+      "   FragColor = texture(tex, TexCoord) * Color;\n"
+      "#else\n"
+      "   FragColor = Color;\n"
+      "   if (Shape.z > 0.5) {\n"
+      "      // Signed distance to the edge, antialiased over one screen pixel\n"
+      "      float d = ShapeDistance(TexCoord);\n"
+      "      FragColor.a *= clamp(0.5 - d / max(fwidth(d), 1e-4), 0.0, 1.0);\n"
       "   }\n"
-      "}\n\0";
-
-  // Vertex Shader
-  GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-  glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-  glCompileShader(vertexShader);
-  int success;
-  char infoLog[512];
-  glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-    std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-              << infoLog << std::endl;
-    return false;
-  }
+      "#endif\n"
+      "   if (lightGrid.w > 0.5) {\n"
+      "      FragColor.rgb *= Lighting(WorldPos);\n"
+      "   }\n"
+      "}\n";
 
-  // Fragment Shader
-  GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-  glCompileShader(fragmentShader);
-  glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-    std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-              << infoLog << std::endl;
+  if (!LoadShaderVariants("sprite", vertexShaderSource, fragmentShaderSource,
+                          m_SpriteShaders)) {
     return false;
   }
 
-  // Link shaders
-  m_ShaderProgram = glCreateProgram();
-  glAttachShader(m_ShaderProgram, vertexShader);
-  glAttachShader(m_ShaderProgram, fragmentShader);
-  glLinkProgram(m_ShaderProgram);
-  glGetProgramiv(m_ShaderProgram, GL_LINK_STATUS, &success);
-  if (!success) {
-    glGetProgramInfoLog(m_ShaderProgram, 512, NULL, infoLog);
-    std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-              << infoLog << std::endl;
-    return false;
+  // Batch shader: geometry is already in world space and color is per vertex
+  const char *batchVertexShaderSource =
+      "#version 330 core\n"
+      "layout (location = 0) in vec2 aPos;\n"
+      "layout (location = 1) in vec2 aTexCoord;\n"
+      "layout (location = 2) in vec4 aColor;\n"
+      "layout (location = 3) in vec4 aShape;\n"
+      "out vec2 TexCoord;\n"
+      "out vec4 Color;\n"
+      "out vec2 WorldPos;\n"
+      "#ifndef TEXTURED\n"
+      "flat out vec4 Shape;\n"
+      "#endif\n"
+      "layout (std140) uniform Camera {\n"
+      "   mat4 view;\n"
+      "   mat4 projection;\n"
+      "   // Light grid origin (xy), tiles per world unit (z), lit (w); see LightGrid\n"
+      "   vec4 lightGrid;\n"
+      "   vec4 lightGridSize;\n"
+      "   vec4 ambient;\n"
+      "   // Animation clock in seconds (x); see AnimationClips\n"
+      "   vec4 clock;\n"
+      "};\n"
+      "void main()\n"
+      "{\n"
+      "   gl_Position = projection * view * vec4(aPos, 0.0, 1.0);\n"
+      "   WorldPos = aPos;\n"
+      "   TexCoord = aTexCoord;\n"
+      "#ifndef TEXTURED\n"
+      "   Shape = aShape;\n"
+      "#endif\n"
+      "   Color = aColor;\n"
+      "}\n";
+
+  return LoadShaderVariants("batch", batchVertexShaderSource, fragmentShaderSource,
+                            m_BatchShaders);
+}
+
+bool Renderer::LoadShaderVariants(const char* vertexName, const char* vertexFallback,
+                                  const char* fragmentFallback, Shader* variants[2]) {
+  // Both programs use sprite.frag; only the vertex stage differs
+  std::string vertexSource;
+  std::string fragmentSource;
+  if (!Shader::ReadFile(std::string("assets/Shaders/") + vertexName + ".vert", vertexSource) ||
+      !Shader::ReadFile("assets/Shaders/sprite.frag", fragmentSource)) {
+    vertexSource = vertexFallback;
+    fragmentSource = fragmentFallback;
   }
-  glDeleteShader(vertexShader);
-  glDeleteShader(fragmentShader);
 
+  const std::vector<std::string> variantDefines[2] = {{"TEXTURED"}, {}};
+  for (int i = 0; i < 2; i++) {
+    variants[i] = new Shader();
+    if (!variants[i]->Compile(vertexSource, fragmentSource, variantDefines[i])) {
+      std::cerr << "Failed to compile " << vertexName << " shader" << std::endl;
+      return false;
+    }
+    variants[i]->BindUniformBlock("Camera", kCameraBlockBinding);
+    variants[i]->Use();
+    glUniform1i(variants[i]->GetUniformLocation("lightData"), LightGrid::kLightDataUnit);
+    glUniform1i(variants[i]->GetUniformLocation("lightIndices"), LightGrid::kLightTilesUnit);
+    glUniform1i(variants[i]->GetUniformLocation("animationClips"), AnimationClips::kTextureUnit);
+  }
   return true;
 }
 
@@ -114,12 +311,12 @@ void Renderer::CreateQuadBuffers() {
   glGenBuffers(1, &m_VBO);
   glGenBuffers(1, &m_EBO);
 
-  glBindVertexArray(m_VAO);
+  m_StateCache->BindVertexArray(m_VAO);
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+  m_StateCache->BindBuffer(GL_ARRAY_BUFFER, m_VBO);
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+  m_StateCache->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices,
                GL_STATIC_DRAW);
 
@@ -133,76 +330,226 @@ void Renderer::CreateQuadBuffers() {
                         (void *)(3 * sizeof(float)));
   glEnableVertexAttribArray(1);
 
-  glBindVertexArray(0);
-}
-
-void Renderer::CreateCircleBuffers() {
-  const int circleSegments = 32;
-  std::vector<float> circleVertices;
-  std::vector<unsigned int> circleIndices;
-  
-  // Center vertex
-  circleVertices.push_back(0.0f); // x
-  circleVertices.push_back(0.0f); // y
-  circleVertices.push_back(0.0f); // z
-  circleVertices.push_back(0.5f); // tex x
-  circleVertices.push_back(0.5f); // tex y
-  
-  // Circle vertices
-  for (int i = 0; i <= circleSegments; i++) {
-    float angle = 2.0f * 3.14159265359f * i / circleSegments;
-    float x = cosf(angle);
-    float y = sinf(angle);
-    circleVertices.push_back(x);  // x
-    circleVertices.push_back(y);  // y
-    circleVertices.push_back(0.0f); // z
-    circleVertices.push_back(x * 0.5f + 0.5f); // tex x
-    circleVertices.push_back(y * 0.5f + 0.5f); // tex y
-  }
-  
-  // Circle indices (triangles from center)
-  for (int i = 0; i < circleSegments; i++) {
-    circleIndices.push_back(0); // center
-    circleIndices.push_back(i + 1);
-    circleIndices.push_back(i + 2);
-  }
-  m_CircleIndexCount = circleIndices.size();
-  
-  glGenVertexArrays(1, &m_CircleVAO);
-  glGenBuffers(1, &m_CircleVBO);
-  glGenBuffers(1, &m_CircleEBO);
-  
-  glBindVertexArray(m_CircleVAO);
-  
-  glBindBuffer(GL_ARRAY_BUFFER, m_CircleVBO);
-  glBufferData(GL_ARRAY_BUFFER, circleVertices.size() * sizeof(float),
-               circleVertices.data(), GL_STATIC_DRAW);
-  
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_CircleEBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-               circleIndices.size() * sizeof(unsigned int),
-               circleIndices.data(), GL_STATIC_DRAW);
-  
-  // Position attribute
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-                        (void *)0);
-  glEnableVertexAttribArray(0);
-  
-  // Texture Coord attribute
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
-                        (void *)(3 * sizeof(float)));
-  glEnableVertexAttribArray(1);
-  
-  glBindVertexArray(0);
+  m_StateCache->BindVertexArray(0);
+}
+
+bool Renderer::CreateStreamBuffers() {
+  // Runs take what is left of a region and end early at its boundary, so a
+  // region only has to hold one sprite; larger regions mean fewer breaks
+  m_VertexStream = new StreamBuffer();
+  m_IndexStream = new StreamBuffer();
+  if (!m_VertexStream->Init(kVertexStreamRegionSize) ||
+      !m_IndexStream->Init(kIndexStreamRegionSize)) {
+    std::cerr << "Failed to create stream buffers!" << std::endl;
+    return false;
+  }
+
+  // The static quad reads its per-instance attributes from the vertex
+  // stream; SpriteBatch re-points them at each run's records
+  m_StateCache->BindVertexArray(m_VAO);
+  m_StateCache->BindBuffer(GL_ARRAY_BUFFER, m_VertexStream->GetID());
+  SpriteBatch::SetInstanceAttributes(0);
+  for (GLuint location = 2; location <= 4; location++) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
+
+  m_StateCache->BindVertexArray(0);
+  return true;
+}
+
+void Renderer::CreateCameraBuffer() {
+  // One buffer holds a std140 block (view + projection + lighting + clock,
+  // 192 bytes) per CameraSpace, in enum order at aligned offsets. Lighting
+  // fields start zeroed and only the World block ever gets them
+  GLint alignment = 256;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  m_CameraBlockStride = ((kCameraBlockSize + alignment - 1) / alignment) * alignment;
+  GLsizeiptr bufferSize = (kCameraSpaceCount - 1) * m_CameraBlockStride + kCameraBlockSize;
+  std::vector<char> zeros((size_t)bufferSize, 0);
+
+  glGenBuffers(1, &m_CameraUBO);
+  m_StateCache->BindBuffer(GL_UNIFORM_BUFFER, m_CameraUBO);
+  glBufferData(GL_UNIFORM_BUFFER, bufferSize, zeros.data(), GL_DYNAMIC_DRAW);
+  m_StateCache->BindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  UseCameraSpace(CameraSpace::World);
+}
+
+void Renderer::UpdateCamera(const Camera& camera, int screenWidth, int screenHeight) {
+  glm::mat4 matrices[4] = {
+      camera.GetViewMatrix(),
+      camera.GetProjectionMatrix(screenWidth, screenHeight),
+      glm::mat4(1.0f),
+      glm::ortho(0.0f, (float)screenWidth, (float)screenHeight, 0.0f, -1.0f, 1.0f)};
+
+  // Tiles cover the view at screen resolution
+  m_LightGrid->Build(camera.GetViewRect(), screenWidth, screenHeight);
+
+  m_StateCache->BindBuffer(GL_UNIFORM_BUFFER, m_CameraUBO);
+  GLintptr worldOffset = (GLintptr)CameraSpace::World * m_CameraBlockStride;
+  glBufferSubData(GL_UNIFORM_BUFFER, worldOffset, 2 * sizeof(glm::mat4), &matrices[0]);
+  glBufferSubData(GL_UNIFORM_BUFFER, worldOffset + 2 * sizeof(glm::mat4), sizeof(LightingBlock),
+                  &m_LightGrid->GetBlock());
+  glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)CameraSpace::WorldUnlit * m_CameraBlockStride,
+                  2 * sizeof(glm::mat4), &matrices[0]);
+  glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)CameraSpace::Screen * m_CameraBlockStride,
+                  2 * sizeof(glm::mat4), &matrices[2]);
+  // Every space animates from the same clock
+  m_AnimationClips->Upload();
+  glm::vec4 clock(m_AnimationClips->GetTime(), 0.0f, 0.0f, 0.0f);
+  for (int space = 0; space < kCameraSpaceCount; space++) {
+    glBufferSubData(GL_UNIFORM_BUFFER, space * m_CameraBlockStride + kClockOffset,
+                    sizeof(glm::vec4), &clock);
+  }
+  m_Stats->AddStreamedBytes(6 * sizeof(glm::mat4) + sizeof(LightingBlock) +
+                            kCameraSpaceCount * sizeof(glm::vec4));
+}
+
+void Renderer::UpdateRegionCamera(const glm::vec4& region) {
+  // Top of the region at the top of the viewport, like the world camera
+  glm::mat4 matrices[2] = {
+      glm::mat4(1.0f),
+      glm::ortho(region.x, region.z, region.w, region.y, -1.0f, 1.0f)};
+
+  m_StateCache->BindBuffer(GL_UNIFORM_BUFFER, m_CameraUBO);
+  glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)CameraSpace::Region * m_CameraBlockStride,
+                  2 * sizeof(glm::mat4), matrices);
+  m_Stats->AddStreamedBytes(2 * sizeof(glm::mat4));
+}
+
+void Renderer::UseCameraSpace(CameraSpace space) {
+  m_StateCache->BindBufferRange(GL_UNIFORM_BUFFER, kCameraBlockBinding, m_CameraUBO,
+                                (GLintptr)space * m_CameraBlockStride, kCameraBlockSize);
+}
+
+void Renderer::BeginFrame() {
+  m_Stats->BeginFrame();
+  m_SpriteBatch->ResetCounters();
+  m_StateCache->ResetCounters();
+}
+
+void Renderer::EndFrame() {
+  m_Stats->EndFrame(m_StateCache->GetIssuedCount(), m_StateCache->GetSkippedCount());
+}
+
+void Renderer::PrepareCommandLists(size_t count) {
+  while (m_CommandLists.size() < count) {
+    m_CommandLists.push_back(new RenderQueue());
+  }
+  for (size_t i = 0; i < count; i++) {
+    m_CommandLists[i]->Clear();
+  }
+  m_ActiveCommandLists = count;
+}
+
+void Renderer::DrawQueue() {
+  for (size_t i = 0; i < m_ActiveCommandLists; i++) {
+    m_RenderQueue->Append(*m_CommandLists[i]);
+    m_CommandLists[i]->Clear();
+  }
+  m_ActiveCommandLists = 0;
+
+  bool hasImages = false;
+  for (const LayerImage& image : m_LayerImages) {
+    hasImages = hasImages || image.texture != 0;
+  }
+
+  m_SpriteBatch->Begin();
+  if (hasImages) {
+    m_RenderQueue->Flush(*m_SpriteBatch, [this](RenderLayer layer) { DrawLayerImage(layer); });
+  } else {
+    m_RenderQueue->Flush(*m_SpriteBatch);
+  }
+  m_SpriteBatch->End();
+
+  for (LayerImage& image : m_LayerImages) {
+    image.texture = 0;
+  }
+}
+
+void Renderer::SetLayerImage(RenderLayer layer, GLuint texture, const glm::vec4& rect) {
+  m_LayerImages[(int)layer] = {texture, rect};
+}
+
+void Renderer::DrawLayerImage(RenderLayer layer) {
+  const LayerImage& image = m_LayerImages[(int)layer];
+  if (image.texture == 0) {
+    return;
+  }
+
+  // Close the previous layer's run, then blend the premultiplied image on
+  // its own. Texture rows run bottom-up, so v is flipped.
+  m_SpriteBatch->End();
+  glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  m_SpriteBatch->Begin();
+  glm::vec2 size(image.rect.z - image.rect.x, image.rect.w - image.rect.y);
+  m_SpriteBatch->SubmitQuad(image.texture, glm::vec2(image.rect.x, image.rect.y) + size * 0.5f,
+                            size, glm::vec4(0.0f, 1.0f, 1.0f, -1.0f));
+  m_SpriteBatch->End();
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  m_SpriteBatch->Begin();
 }
 
 void Renderer::Cleanup() {
-  glDeleteVertexArrays(1, &m_VAO);
-  glDeleteBuffers(1, &m_VBO);
-  glDeleteBuffers(1, &m_EBO);
-  glDeleteVertexArrays(1, &m_CircleVAO);
-  glDeleteBuffers(1, &m_CircleVBO);
-  glDeleteBuffers(1, &m_CircleEBO);
-  glDeleteProgram(m_ShaderProgram);
+  if (!m_StateCache) {
+    return;
+  }
+  delete m_RenderQueue;
+  m_RenderQueue = nullptr;
+  for (RenderQueue* list : m_CommandLists) {
+    delete list;
+  }
+  m_CommandLists.clear();
+  m_ActiveCommandLists = 0;
+  if (m_AnimationClips) {
+    m_AnimationClips->Cleanup();
+    delete m_AnimationClips;
+    m_AnimationClips = nullptr;
+  }
+  if (m_LightGrid) {
+    m_LightGrid->Cleanup();
+    delete m_LightGrid;
+    m_LightGrid = nullptr;
+  }
+#ifdef LEO_DEBUG_DRAW
+  if (m_DebugDraw) {
+    DebugDraw::SetCurrent(nullptr);
+    m_DebugDraw->Cleanup();
+    delete m_DebugDraw;
+    m_DebugDraw = nullptr;
+  }
+#endif
+  if (m_SpriteBatch) {
+    m_SpriteBatch->Cleanup();
+    delete m_SpriteBatch;
+    m_SpriteBatch = nullptr;
+  }
+  for (int i = 0; i < 2; i++) {
+    delete m_SpriteShaders[i];
+    delete m_BatchShaders[i];
+    m_SpriteShaders[i] = nullptr;
+    m_BatchShaders[i] = nullptr;
+  }
+  delete m_VertexStream;
+  delete m_IndexStream;
+  m_VertexStream = nullptr;
+  m_IndexStream = nullptr;
+  m_StateCache->DeleteBuffer(m_CameraUBO);
+  m_StateCache->DeleteVertexArray(m_VAO);
+  m_StateCache->DeleteBuffer(m_VBO);
+  m_StateCache->DeleteBuffer(m_EBO);
+  m_CameraUBO = 0;
+  m_VAO = m_VBO = m_EBO = 0;
+
+  RenderStats::SetCurrent(nullptr);
+  m_Stats->Cleanup();
+  delete m_Stats;
+  m_Stats = nullptr;
+
+  // Last, other subsystems release their GL objects through it
+  GLStateCache::SetCurrent(nullptr);
+  delete m_StateCache;
+  m_StateCache = nullptr;
 }
 
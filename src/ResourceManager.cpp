@@ -1,8 +1,11 @@
 #include "ResourceManager.h"
 #include <iostream>
-#include <map>
 
-ResourceManager::ResourceManager() : m_TextRenderer(nullptr) {
+ResourceManager::ResourceManager()
+    : m_Pack(nullptr), m_Atlas(nullptr), m_Streamer(nullptr), m_TextRenderer(nullptr) {
+  m_Pack = new AssetPack();
+  m_Atlas = new TextureAtlas();
+  m_Streamer = new TextureStreamer();
   m_TextRenderer = new TextRenderer();
 }
 
@@ -10,106 +13,178 @@ ResourceManager::~ResourceManager() {
   Cleanup();
 }
 
-bool ResourceManager::LoadTexture(const std::string& name, const std::string& path) {
+bool ResourceManager::OpenPack(const std::string& path) {
+  return m_Pack->Open(path);
+}
+
+const AssetPackEntry* ResourceManager::FindInPack(const std::string& path,
+                                                  AssetType type) const {
+  const AssetPackEntry* entry = m_Pack ? m_Pack->Find(path) : nullptr;
+  if (!entry || entry->type != type) {
+    return nullptr;
+  }
+  // An asset edited since the last cook loads from its loose file
+  if (!AssetPack::MatchesSource(*entry, path)) {
+    std::cout << "Asset pack entry out of date, loading " << path << std::endl;
+    return nullptr;
+  }
+  return entry;
+}
+
+TextureHandle ResourceManager::AddTexture(AssetId name, Texture* texture) {
+  Texture* replaced = nullptr;
+  TextureHandle handle = m_Textures.Insert(name, texture, &replaced);
+  if (replaced) {
+    m_RetiredTextures.push_back(replaced);
+  }
+  return handle;
+}
+
+bool ResourceManager::LoadTexture(AssetId name, const std::string& path) {
+  return LoadSpriteSheet(name, path, 0, 0);
+}
+
+bool ResourceManager::LoadSpriteSheet(AssetId name, const std::string& path,
+                                      int frameWidth, int frameHeight) {
   Texture* texture = new Texture();
-  if (texture->Load(path.c_str())) {
-    m_Textures[name] = texture;
+  bool loaded;
+  if (const AssetPackEntry* entry = FindInPack(path, AssetType::Texture)) {
+    loaded = texture->LoadIntoAtlas(m_Pack->GetData(*entry), (int)entry->info[0],
+                                    (int)entry->info[1], (int)entry->info[2], path.c_str(),
+                                    *m_Atlas, frameWidth, frameHeight);
+  } else {
+    loaded = texture->LoadIntoAtlas(path.c_str(), *m_Atlas, frameWidth, frameHeight);
+  }
+  if (loaded) {
+    AddTexture(name, texture);
     return true;
   }
   delete texture;
   return false;
 }
 
-Texture* ResourceManager::GetTexture(const std::string& name) {
-  auto it = m_Textures.find(name);
-  if (it != m_Textures.end()) {
-    return it->second;
+TextureHandle ResourceManager::LoadTextureAsync(AssetId name, const std::string& path,
+                                                ThreadPool* pool) {
+  Texture* texture = new Texture();
+  // Cooked pixels need no decode, only the budgeted upload
+  if (const AssetPackEntry* entry = FindInPack(path, AssetType::Texture)) {
+    m_Streamer->RequestPixels(texture, m_Pack->GetData(*entry), (int)entry->info[0],
+                              (int)entry->info[1], path);
+  } else {
+    m_Streamer->Request(texture, path, pool);
   }
-  return nullptr;
+  return AddTexture(name, texture);
+}
+
+int ResourceManager::UpdateTextureUploads(double budgetMs) {
+  return m_Streamer->Update(budgetMs);
 }
 
-bool ResourceManager::LoadSound(const std::string& name, const std::string& path) {
-  Mix_Chunk* sound = Mix_LoadWAV(path.c_str());
+bool ResourceManager::LoadSound(AssetId name, const std::string& path) {
+  // Cooked PCM plays straight from the mapping if it is in the mixer's
+  // format; the chunk does not own the samples
+  int frequency = 0, channels = 0;
+  Uint16 format = 0;
+  const AssetPackEntry* entry = FindInPack(path, AssetType::Sound);
+  Mix_Chunk* sound = nullptr;
+  if (entry && Mix_QuerySpec(&frequency, &format, &channels) &&
+      entry->info[0] == (uint32_t)frequency && entry->info[1] == format &&
+      entry->info[2] == (uint32_t)channels) {
+    sound = Mix_QuickLoad_RAW((Uint8*)m_Pack->GetData(*entry), (Uint32)entry->size);
+  }
+  if (sound == nullptr) {
+    sound = Mix_LoadWAV(path.c_str());
+  }
   if (sound != nullptr) {
-    m_Sounds[name] = sound;
+    Mix_Chunk* replaced = nullptr;
+    m_Sounds.Insert(name, sound, &replaced);
+    if (replaced) {
+      Mix_FreeChunk(replaced);
+    }
     return true;
   }
   std::cerr << "Failed to load sound: " << path << " - " << Mix_GetError() << std::endl;
   return false;
 }
 
-Mix_Chunk* ResourceManager::GetSound(const std::string& name) {
-  auto it = m_Sounds.find(name);
-  if (it != m_Sounds.end()) {
-    return it->second;
+bool ResourceManager::LoadMusic(AssetId name, const std::string& path) {
+  // Music stays compressed in the pack and streams from the mapping
+  Mix_Music* music = nullptr;
+  if (const AssetPackEntry* entry = FindInPack(path, AssetType::Blob)) {
+    music = Mix_LoadMUS_RW(SDL_RWFromConstMem(m_Pack->GetData(*entry), (int)entry->size), 1);
+  } else {
+    music = Mix_LoadMUS(path.c_str());
   }
-  return nullptr;
-}
-
-bool ResourceManager::LoadMusic(const std::string& name, const std::string& path) {
-  Mix_Music* music = Mix_LoadMUS(path.c_str());
   if (music != nullptr) {
-    m_Music[name] = music;
+    Mix_Music* replaced = nullptr;
+    m_Music.Insert(name, music, &replaced);
+    if (replaced) {
+      Mix_FreeMusic(replaced);
+    }
     return true;
   }
   std::cerr << "Failed to load music: " << path << " - " << Mix_GetError() << std::endl;
   return false;
 }
 
-Mix_Music* ResourceManager::GetMusic(const std::string& name) {
-  auto it = m_Music.find(name);
-  if (it != m_Music.end()) {
-    return it->second;
-  }
-  return nullptr;
-}
-
 bool ResourceManager::LoadFont(const std::string& path, int fontSize) {
-  if (m_TextRenderer) {
-    return m_TextRenderer->LoadFont(path.c_str(), fontSize);
+  if (!m_TextRenderer) {
+    return false;
   }
-  return false;
+  if (const AssetPackEntry* entry = FindInPack(path, AssetType::Blob)) {
+    return m_TextRenderer->LoadFontMemory(m_Pack->GetData(*entry), (size_t)entry->size,
+                                          fontSize, path.c_str());
+  }
+  return m_TextRenderer->LoadFont(path.c_str(), fontSize);
 }
 
-void ResourceManager::PlayMusic(const std::string& name, int loops) {
+void ResourceManager::PlayMusic(AssetId name, int loops) {
   Mix_Music* music = GetMusic(name);
   if (music) {
     Mix_PlayMusic(music, loops);
   }
 }
 
-void ResourceManager::PlaySound(const std::string& name) {
-  Mix_Chunk* sound = GetSound(name);
+void ResourceManager::PlaySound(Mix_Chunk* sound) {
   if (sound) {
     Mix_PlayChannel(-1, sound, 0);
   }
 }
 
 void ResourceManager::Cleanup() {
-  // Cleanup textures
-  for (auto& pair : m_Textures) {
-    if (pair.second) {
-      pair.second->Cleanup();
-      delete pair.second;
-    }
+  // Finish in-flight decodes before deleting the textures they target
+  if (m_Streamer) {
+    m_Streamer->Cleanup();
+    delete m_Streamer;
+    m_Streamer = nullptr;
   }
-  m_Textures.clear();
 
-  // Cleanup sounds
-  for (auto& pair : m_Sounds) {
-    if (pair.second) {
-      Mix_FreeChunk(pair.second);
-    }
+  // Cleanup textures; Clear makes outstanding handles stale
+  m_Textures.ForEach([](Texture* texture) {
+    texture->Cleanup();
+    delete texture;
+  });
+  m_Textures.Clear();
+  for (Texture* texture : m_RetiredTextures) {
+    texture->Cleanup();
+    delete texture;
   }
-  m_Sounds.clear();
+  m_RetiredTextures.clear();
 
-  // Cleanup music
-  for (auto& pair : m_Music) {
-    if (pair.second) {
-      Mix_FreeMusic(pair.second);
-    }
+  // Cleanup atlas pages after the textures referencing them
+  if (m_Atlas) {
+    m_Atlas->Cleanup();
+    delete m_Atlas;
+    m_Atlas = nullptr;
   }
-  m_Music.clear();
+
+  // Cleanup sounds
+  m_Sounds.ForEach([](Mix_Chunk* sound) { Mix_FreeChunk(sound); });
+  m_Sounds.Clear();
+
+  // Cleanup music
+  m_Music.ForEach([](Mix_Music* music) { Mix_FreeMusic(music); });
+  m_Music.Clear();
 
   // Cleanup text renderer
   if (m_TextRenderer) {
@@ -117,5 +192,12 @@ void ResourceManager::Cleanup() {
     delete m_TextRenderer;
     m_TextRenderer = nullptr;
   }
+
+  // Unmap last; chunks, music and the font may still have pointed into it
+  if (m_Pack) {
+    m_Pack->Close();
+    delete m_Pack;
+    m_Pack = nullptr;
+  }
 }
 
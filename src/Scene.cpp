@@ -1,6 +1,7 @@
 #include "Scene.h"
+#include <algorithm>
 
-Scene::Scene() {}
+Scene::Scene() : m_LayerStatic{}, m_LayerRevisions{}, m_Revision(0) {}
 
 Scene::~Scene() {
   Cleanup();
@@ -9,6 +10,8 @@ Scene::~Scene() {
 void Scene::AddGameObject(GameObject* obj) {
   if (obj) {
     m_GameObjects.push_back(obj);
+    m_Grid.Insert((uint32_t)(m_GameObjects.size() - 1), GetBounds(*obj));
+    InvalidateLayer(obj->layer);
   }
 }
 
@@ -23,6 +26,7 @@ void Scene::UpdatePlayerMovement(glm::vec2 movement, float speed, float deltaTim
   if (m_GameObjects.size() == 0) return;
   
   GameObject* player = m_GameObjects[0];
+  glm::vec2 previousPosition = player->position;
   glm::vec2 nextPosition = player->position + movement * speed * deltaTime;
   
   // Check collision with potential new position
@@ -63,6 +67,10 @@ void Scene::UpdatePlayerMovement(glm::vec2 movement, float speed, float deltaTim
   if (canMoveY) {
     player->position.y = nextPosition.y;
   }
+  // Standing still must leave the revision alone, or idle frames redraw
+  if (player->position != previousPosition) {
+    OnObjectMoved(0);
+  }
   
   wasColliding = isColliding;
 }
@@ -79,10 +87,34 @@ void Scene::CheckCollisions(GameObject* player, bool& isColliding) {
   }
 }
 
+void Scene::OnObjectMoved(size_t index) {
+  if (index < m_GameObjects.size()) {
+    m_Grid.Update((uint32_t)index, GetBounds(*m_GameObjects[index]));
+    InvalidateLayer(m_GameObjects[index]->layer);
+  }
+}
+
+const std::vector<uint32_t>& Scene::Cull(const glm::vec4& viewRect) {
+  m_VisibleIndices.clear();
+  m_Grid.Query(viewRect, m_VisibleIndices);
+  // Keep the submission order objects were added in
+  std::sort(m_VisibleIndices.begin(), m_VisibleIndices.end());
+  return m_VisibleIndices;
+}
+
+glm::vec4 Scene::GetBounds(const GameObject& obj) {
+  return obj.GetDrawBounds();
+}
+
 void Scene::Cleanup() {
   for (GameObject* obj : m_GameObjects) {
     delete obj;
   }
   m_GameObjects.clear();
+  m_Grid.Clear();
+  m_VisibleIndices.clear();
+  for (int layer = 0; layer < kRenderLayerCount; layer++) {
+    InvalidateLayer((RenderLayer)layer);
+  }
 }
 
@@ -0,0 +1,158 @@
+#include "Shader.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+Shader::Shader() : m_ID(0) {}
+
+Shader::~Shader() {
+  Cleanup();
+}
+
+bool Shader::Compile(const std::string& vertexSource, const std::string& fragmentSource,
+                     const std::vector<std::string>& defines) {
+  GLuint vertexShader = CompileStage(GL_VERTEX_SHADER, InjectDefines(vertexSource, defines));
+  if (vertexShader == 0) {
+    return false;
+  }
+  GLuint fragmentShader = CompileStage(GL_FRAGMENT_SHADER, InjectDefines(fragmentSource, defines));
+  if (fragmentShader == 0) {
+    glDeleteShader(vertexShader);
+    return false;
+  }
+
+  // Link shaders
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertexShader);
+  glAttachShader(program, fragmentShader);
+  glLinkProgram(program);
+  glDeleteShader(vertexShader);
+  glDeleteShader(fragmentShader);
+
+  int success;
+  char infoLog[512];
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    glGetProgramInfoLog(program, 512, NULL, infoLog);
+    std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+              << infoLog << std::endl;
+    glDeleteProgram(program);
+    return false;
+  }
+
+  Cleanup();
+  m_ID = program;
+  CacheUniformLocations();
+  return true;
+}
+
+bool Shader::LoadFromFiles(const std::string& vertexPath, const std::string& fragmentPath,
+                           const std::vector<std::string>& defines) {
+  std::string vertexSource;
+  std::string fragmentSource;
+  if (!ReadFile(vertexPath, vertexSource) || !ReadFile(fragmentPath, fragmentSource)) {
+    return false;
+  }
+  return Compile(vertexSource, fragmentSource, defines);
+}
+
+void Shader::Cleanup() {
+  if (m_ID != 0) {
+    GLStateCache::Get()->DeleteProgram(m_ID);
+    m_ID = 0;
+  }
+  m_UniformLocations.clear();
+}
+
+GLint Shader::GetUniformLocation(const std::string& name) const {
+  auto it = m_UniformLocations.find(name);
+  if (it != m_UniformLocations.end()) {
+    return it->second;
+  }
+  return -1;
+}
+
+void Shader::BindUniformBlock(const char* blockName, GLuint bindingPoint) {
+  GLuint blockIndex = glGetUniformBlockIndex(m_ID, blockName);
+  if (blockIndex != GL_INVALID_INDEX) {
+    glUniformBlockBinding(m_ID, blockIndex, bindingPoint);
+  }
+}
+
+bool Shader::ReadFile(const std::string& path, std::string& contents) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+GLuint Shader::CompileStage(GLenum type, const std::string& source) {
+  GLuint shader = glCreateShader(type);
+  const char* sourcePtr = source.c_str();
+  glShaderSource(shader, 1, &sourcePtr, NULL);
+  glCompileShader(shader);
+
+  int success;
+  char infoLog[512];
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    glGetShaderInfoLog(shader, 512, NULL, infoLog);
+    std::cerr << "ERROR::SHADER::"
+              << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT")
+              << "::COMPILATION_FAILED\n"
+              << infoLog << std::endl;
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+std::string Shader::InjectDefines(const std::string& source,
+                                  const std::vector<std::string>& defines) {
+  if (defines.empty()) {
+    return source;
+  }
+
+  std::string defineBlock;
+  for (const std::string& define : defines) {
+    defineBlock += "#define " + define + "\n";
+  }
+
+  // #version must stay the first statement, so insert right after it
+  size_t insertAt = 0;
+  if (source.compare(0, 8, "#version") == 0) {
+    size_t lineEnd = source.find('\n');
+    insertAt = (lineEnd == std::string::npos) ? source.size() : lineEnd + 1;
+  }
+  std::string result = source;
+  result.insert(insertAt, defineBlock);
+  return result;
+}
+
+void Shader::CacheUniformLocations() {
+  GLint uniformCount = 0;
+  glGetProgramiv(m_ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+  char name[256];
+  for (GLint i = 0; i < uniformCount; i++) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(m_ID, (GLuint)i, sizeof(name), &length, &size, &type, name);
+
+    // Uniforms inside blocks have no location
+    GLint location = glGetUniformLocation(m_ID, name);
+    if (location != -1) {
+      std::string uniformName(name, length);
+      m_UniformLocations[uniformName] = location;
+      // Arrays are reported as "name[0]", also allow lookup by "name"
+      if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+        m_UniformLocations[uniformName.substr(0, uniformName.size() - 3)] = location;
+      }
+    }
+  }
+}
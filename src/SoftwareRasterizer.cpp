@@ -0,0 +1,340 @@
+#include "SoftwareRasterizer.h"
+#include "SpriteBatch.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RASTERIZER_SSE2 1
+#endif
+
+#include "stb_image.h"
+#include "stb_image_write.h"
+
+namespace {
+
+uint32_t PackColor(glm::vec4 color) {
+  glm::vec4 bytes = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+  return (uint32_t)bytes.r | (uint32_t)bytes.g << 8 | (uint32_t)bytes.b << 16 |
+         (uint32_t)bytes.a << 24;
+}
+
+// x / 255 rounded to nearest, exact for x <= 65025 + 127
+inline uint32_t Div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+// Texel times vertex color, per channel, as the shader multiplies them
+inline uint32_t Modulate(uint32_t texel, uint32_t color) {
+  if (color == 0xFFFFFFFFu) {
+    return texel;
+  }
+  uint32_t result = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    result |= Div255(((texel >> shift) & 0xFF) * ((color >> shift) & 0xFF)) << shift;
+  }
+  return result;
+}
+
+// SRC_ALPHA, ONE_MINUS_SRC_ALPHA on all four channels
+inline uint32_t BlendPixel(uint32_t source, uint32_t destination) {
+  uint32_t alpha = source >> 24;
+  uint32_t result = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    uint32_t s = (source >> shift) & 0xFF;
+    uint32_t d = (destination >> shift) & 0xFF;
+    result |= Div255(s * alpha + d * (255 - alpha)) << shift;
+  }
+  return result;
+}
+
+#ifdef RASTERIZER_SSE2
+// BlendPixel on four pixels: channels widened to 16 bits, two pixels per
+// register, with the same rounding
+inline __m128i Blend4(__m128i source, __m128i destination) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i full = _mm_set1_epi16(255);
+  const __m128i half = _mm_set1_epi16(128);
+  __m128i result[2];
+  for (int i = 0; i < 2; i++) {
+    __m128i s = i == 0 ? _mm_unpacklo_epi8(source, zero) : _mm_unpackhi_epi8(source, zero);
+    __m128i d = i == 0 ? _mm_unpacklo_epi8(destination, zero)
+                       : _mm_unpackhi_epi8(destination, zero);
+    // Each pixel's alpha in all four of its lanes
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)),
+                                        _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(s, alpha),
+                              _mm_mullo_epi16(d, _mm_sub_epi16(full, alpha)));
+    x = _mm_add_epi16(x, half);
+    result[i] = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+  }
+  return _mm_packus_epi16(result[0], result[1]);
+}
+#endif
+
+void BlendSpan(uint32_t* destination, const uint32_t* source, int count) {
+  int i = 0;
+#ifdef RASTERIZER_SSE2
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = _mm_loadu_si128((const __m128i*)(source + i));
+    __m128i d = _mm_loadu_si128((const __m128i*)(destination + i));
+    _mm_storeu_si128((__m128i*)(destination + i), Blend4(s, d));
+  }
+#endif
+  for (; i < count; i++) {
+    destination[i] = BlendPixel(source[i], destination[i]);
+  }
+}
+
+void FillSpan(uint32_t* destination, uint32_t color, int count) {
+  if ((color >> 24) == 0xFF) {
+    std::fill(destination, destination + count, color);
+    return;
+  }
+  int i = 0;
+#ifdef RASTERIZER_SSE2
+  __m128i s = _mm_set1_epi32((int)color);
+  for (; i + 4 <= count; i += 4) {
+    __m128i d = _mm_loadu_si128((const __m128i*)(destination + i));
+    _mm_storeu_si128((__m128i*)(destination + i), Blend4(s, d));
+  }
+#endif
+  for (; i < count; i++) {
+    destination[i] = BlendPixel(color, destination[i]);
+  }
+}
+
+inline int Wrap(int texel, int size) {
+  texel %= size;
+  return texel < 0 ? texel + size : texel;
+}
+
+// Same as ShapeDistance in the sprite fragment shader
+float ShapeDistance(glm::vec2 p, const glm::vec4& shape) {
+  glm::vec2 halfSize(shape.x, shape.y);
+  float shortHalf = std::min(halfSize.x, halfSize.y);
+  int kind = (int)(shape.z + 0.5f);
+  if (kind <= 2) {
+    float d = (glm::length(p / glm::max(halfSize, glm::vec2(1e-4f))) - 1.0f) * shortHalf;
+    return kind == 2 ? std::fabs(d + shape.w * 0.5f) - shape.w * 0.5f : d;
+  }
+  float radius = kind == 4 ? shortHalf : glm::clamp(shape.w, 0.0f, shortHalf);
+  glm::vec2 q = glm::abs(p) - halfSize + radius;
+  return glm::length(glm::max(q, glm::vec2(0.0f))) + std::min(std::max(q.x, q.y), 0.0f) -
+         radius;
+}
+
+}  // namespace
+
+SoftwareRasterizer::SoftwareRasterizer()
+    : m_Width(0), m_Height(0), m_Pool(nullptr), m_AnimationClips(nullptr),
+      m_ViewOrigin(0.0f), m_ViewScale(1.0f), m_TileColumns(0), m_TileRows(0) {}
+
+SoftwareRasterizer::~SoftwareRasterizer() {}
+
+bool SoftwareRasterizer::Init(int width, int height, ThreadPool* pool) {
+  if (width <= 0 || height <= 0) {
+    std::cerr << "Invalid software render target size " << width << "x" << height
+              << std::endl;
+    return false;
+  }
+  m_Width = width;
+  m_Height = height;
+  m_Pool = pool;
+  m_Pixels.assign((size_t)width * height, 0);
+  m_TileColumns = (width + kTileSize - 1) / kTileSize;
+  m_TileRows = (height + kTileSize - 1) / kTileSize;
+  m_TileCommands.assign((size_t)m_TileColumns * m_TileRows, {});
+  SetView(glm::vec4(0.0f, 0.0f, (float)width, (float)height));
+  return true;
+}
+
+GLuint SoftwareRasterizer::AddTexture(int width, int height, const uint8_t* rgba) {
+  SoftTexture texture;
+  texture.width = width;
+  texture.height = height;
+  texture.texels.resize((size_t)width * height);
+  for (size_t i = 0; i < texture.texels.size(); i++) {
+    const uint8_t* texel = rgba + i * 4;
+    texture.texels[i] = (uint32_t)texel[0] | (uint32_t)texel[1] << 8 |
+                        (uint32_t)texel[2] << 16 | (uint32_t)texel[3] << 24;
+  }
+  m_Textures.push_back(std::move(texture));
+  return (GLuint)m_Textures.size();
+}
+
+GLuint SoftwareRasterizer::LoadTexture(const char* path, int* width, int* height) {
+  int w = 0, h = 0, channels = 0;
+  unsigned char* data = stbi_load(path, &w, &h, &channels, 4);
+  if (!data) {
+    std::cerr << "Failed to load texture: " << path << std::endl;
+    return 0;
+  }
+  GLuint id = AddTexture(w, h, data);
+  stbi_image_free(data);
+  if (width) {
+    *width = w;
+  }
+  if (height) {
+    *height = h;
+  }
+  return id;
+}
+
+void SoftwareRasterizer::SetView(const glm::vec4& viewRect) {
+  m_ViewOrigin = glm::vec2(viewRect.x, viewRect.y);
+  m_ViewScale = glm::vec2(m_Width / (viewRect.z - viewRect.x),
+                          m_Height / (viewRect.w - viewRect.y));
+}
+
+void SoftwareRasterizer::Clear(glm::vec4 color) {
+  std::fill(m_Pixels.begin(), m_Pixels.end(), PackColor(color));
+}
+
+void SoftwareRasterizer::Begin() {
+  m_Commands.clear();
+}
+
+void SoftwareRasterizer::SubmitQuad(GLuint texture, glm::vec2 position, glm::vec2 size,
+                                    glm::vec4 uvRect, glm::vec4 color) {
+  if (texture > m_Textures.size()) {
+    return;
+  }
+  glm::vec2 halfSize = size * 0.5f;
+  glm::vec2 a = (position - halfSize - m_ViewOrigin) * m_ViewScale;
+  glm::vec2 b = (position + halfSize - m_ViewOrigin) * m_ViewScale;
+
+  Command command;
+  command.min = glm::min(a, b);
+  command.max = glm::max(a, b);
+  // Pixels whose centers fall inside, like GL's rasterization rule
+  command.x0 = std::max(0, (int)std::ceil(command.min.x - 0.5f));
+  command.y0 = std::max(0, (int)std::ceil(command.min.y - 0.5f));
+  command.x1 = std::min(m_Width, (int)std::ceil(command.max.x - 0.5f));
+  command.y1 = std::min(m_Height, (int)std::ceil(command.max.y - 0.5f));
+  if (command.x0 >= command.x1 || command.y0 >= command.y1) {
+    return;
+  }
+  command.texture = texture;
+  command.color = PackColor(color);
+  command.uv = glm::vec4(0.0f);
+  command.shape = glm::vec4(0.0f);
+
+  if (texture == 0) {
+    // Shape in the shader's units, scaled to pixels
+    command.shape = glm::vec4(glm::abs(halfSize * m_ViewScale), uvRect.x,
+                              uvRect.y * m_ViewScale.x);
+  } else {
+    if (m_AnimationClips && SpriteBatch::IsAnimationParams(uvRect)) {
+      uvRect = m_AnimationClips->Evaluate((int)uvRect.x, uvRect.y);
+    }
+    // Corners keep their coordinates when a negative size flips the quad
+    glm::vec2 uvA(uvRect.x, uvRect.y);
+    glm::vec2 uvB(uvRect.x + uvRect.z, uvRect.y + uvRect.w);
+    command.uv = glm::vec4(a.x <= b.x ? uvA.x : uvB.x, a.y <= b.y ? uvA.y : uvB.y,
+                           a.x <= b.x ? uvB.x : uvA.x, a.y <= b.y ? uvB.y : uvA.y);
+  }
+  m_Commands.push_back(command);
+}
+
+void SoftwareRasterizer::End() {
+  for (std::vector<uint32_t>& list : m_TileCommands) {
+    list.clear();
+  }
+  for (uint32_t i = 0; i < (uint32_t)m_Commands.size(); i++) {
+    const Command& command = m_Commands[i];
+    for (int ty = command.y0 / kTileSize; ty <= (command.y1 - 1) / kTileSize; ty++) {
+      for (int tx = command.x0 / kTileSize; tx <= (command.x1 - 1) / kTileSize; tx++) {
+        m_TileCommands[ty * m_TileColumns + tx].push_back(i);
+      }
+    }
+  }
+
+  // Tiles own disjoint pixels, so they need no synchronization
+  size_t tileCount = m_TileCommands.size();
+  size_t chunkCount = m_Pool ? std::min(tileCount, (size_t)m_Pool->GetThreadCount() + 1) : 1;
+  if (chunkCount > 1) {
+    m_Pool->ParallelFor(tileCount, chunkCount, [this](size_t, size_t begin, size_t end) {
+      for (size_t tile = begin; tile < end; tile++) {
+        RasterizeTile((int)tile);
+      }
+    });
+  } else {
+    for (size_t tile = 0; tile < tileCount; tile++) {
+      RasterizeTile((int)tile);
+    }
+  }
+  m_Commands.clear();
+}
+
+void SoftwareRasterizer::RasterizeTile(int tile) {
+  int tileX = (tile % m_TileColumns) * kTileSize;
+  int tileY = (tile / m_TileColumns) * kTileSize;
+  for (uint32_t index : m_TileCommands[tile]) {
+    const Command& command = m_Commands[index];
+    DrawCommand(command, std::max(command.x0, tileX), std::max(command.y0, tileY),
+                std::min(command.x1, tileX + kTileSize),
+                std::min(command.y1, tileY + kTileSize));
+  }
+}
+
+void SoftwareRasterizer::DrawCommand(const Command& command, int x0, int y0, int x1, int y1) {
+  int count = x1 - x0;
+  uint32_t source[kTileSize];
+
+  if (command.texture == 0) {
+    for (int y = y0; y < y1; y++) {
+      uint32_t* destination = &m_Pixels[(size_t)y * m_Width + x0];
+      if (command.shape.z < 0.5f) {
+        FillSpan(destination, command.color, count);
+      } else {
+        DrawShapeSpan(command, y, x0, x1, source);
+        BlendSpan(destination, source, count);
+      }
+    }
+    return;
+  }
+
+  // Texture coordinates interpolate linearly across the quad and are
+  // sampled at pixel centers
+  const SoftTexture& texture = m_Textures[command.texture - 1];
+  glm::vec2 extent = command.max - command.min;
+  float du = (command.uv.z - command.uv.x) / extent.x;
+  float dv = (command.uv.w - command.uv.y) / extent.y;
+  for (int y = y0; y < y1; y++) {
+    float v = command.uv.y + (y + 0.5f - command.min.y) * dv;
+    int row = Wrap((int)std::floor(v * texture.height), texture.height);
+    const uint32_t* texels = &texture.texels[(size_t)row * texture.width];
+    for (int i = 0; i < count; i++) {
+      float u = command.uv.x + (x0 + i + 0.5f - command.min.x) * du;
+      int column = Wrap((int)std::floor(u * texture.width), texture.width);
+      source[i] = Modulate(texels[column], command.color);
+    }
+    BlendSpan(&m_Pixels[(size_t)y * m_Width + x0], source, count);
+  }
+}
+
+void SoftwareRasterizer::DrawShapeSpan(const Command& command, int y, int x0, int x1,
+                                       uint32_t* source) {
+  glm::vec2 center = (command.min + command.max) * 0.5f;
+  float alpha = (float)(command.color >> 24);
+  for (int x = x0; x < x1; x++) {
+    glm::vec2 p = glm::vec2(x + 0.5f, y + 0.5f) - center;
+    float d = ShapeDistance(p, command.shape);
+    // fwidth over a pixel step, as the fragment shader measures it
+    float width = std::fabs(ShapeDistance(p + glm::vec2(1.0f, 0.0f), command.shape) - d) +
+                  std::fabs(ShapeDistance(p + glm::vec2(0.0f, 1.0f), command.shape) - d);
+    float coverage = glm::clamp(0.5f - d / std::max(width, 1e-4f), 0.0f, 1.0f);
+    uint32_t a = (uint32_t)(alpha * coverage + 0.5f);
+    source[x - x0] = (command.color & 0x00FFFFFFu) | a << 24;
+  }
+}
+
+bool SoftwareRasterizer::SavePNG(const char* path) const {
+  if (!stbi_write_png(path, m_Width, m_Height, 4, m_Pixels.data(), m_Width * 4)) {
+    std::cerr << "Failed to write " << path << std::endl;
+    return false;
+  }
+  return true;
+}
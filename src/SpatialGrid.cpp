@@ -0,0 +1,129 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize) : m_CellSize(cellSize), m_CurrentStamp(0) {}
+
+glm::ivec2 SpatialGrid::CellOf(float x, float y) const {
+  return glm::ivec2((int)std::floor(x / m_CellSize), (int)std::floor(y / m_CellSize));
+}
+
+uint64_t SpatialGrid::CellKey(int x, int y) {
+  return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y;
+}
+
+void SpatialGrid::Insert(uint32_t id, const glm::vec4& bounds) {
+  if (id >= m_Entries.size()) {
+    m_Entries.resize(id + 1, Entry{false, glm::vec4(0.0f), glm::ivec2(0), glm::ivec2(0)});
+    m_QueryStamps.resize(id + 1, 0);
+  }
+  if (m_Entries[id].present) {
+    Update(id, bounds);
+    return;
+  }
+
+  Entry& entry = m_Entries[id];
+  entry.present = true;
+  entry.bounds = bounds;
+  entry.minCell = CellOf(bounds.x, bounds.y);
+  entry.maxCell = CellOf(bounds.z, bounds.w);
+  AddToCells(id, entry.minCell, entry.maxCell);
+}
+
+void SpatialGrid::Update(uint32_t id, const glm::vec4& bounds) {
+  if (id >= m_Entries.size() || !m_Entries[id].present) {
+    Insert(id, bounds);
+    return;
+  }
+
+  Entry& entry = m_Entries[id];
+  entry.bounds = bounds;
+  glm::ivec2 minCell = CellOf(bounds.x, bounds.y);
+  glm::ivec2 maxCell = CellOf(bounds.z, bounds.w);
+
+  // Moving within the same cells only needs the new bounds
+  if (minCell == entry.minCell && maxCell == entry.maxCell) {
+    return;
+  }
+  RemoveFromCells(id, entry.minCell, entry.maxCell);
+  entry.minCell = minCell;
+  entry.maxCell = maxCell;
+  AddToCells(id, minCell, maxCell);
+}
+
+void SpatialGrid::Remove(uint32_t id) {
+  if (id >= m_Entries.size() || !m_Entries[id].present) {
+    return;
+  }
+  Entry& entry = m_Entries[id];
+  RemoveFromCells(id, entry.minCell, entry.maxCell);
+  entry.present = false;
+}
+
+void SpatialGrid::Clear() {
+  m_Cells.clear();
+  m_Entries.clear();
+  m_QueryStamps.clear();
+  m_CurrentStamp = 0;
+}
+
+void SpatialGrid::Query(const glm::vec4& rect, std::vector<uint32_t>& results) {
+  // Stamps dedupe ids that span several cells without clearing a set
+  m_CurrentStamp++;
+  if (m_CurrentStamp == 0) {
+    std::fill(m_QueryStamps.begin(), m_QueryStamps.end(), 0);
+    m_CurrentStamp = 1;
+  }
+
+  glm::ivec2 minCell = CellOf(rect.x, rect.y);
+  glm::ivec2 maxCell = CellOf(rect.z, rect.w);
+  for (int y = minCell.y; y <= maxCell.y; y++) {
+    for (int x = minCell.x; x <= maxCell.x; x++) {
+      auto it = m_Cells.find(CellKey(x, y));
+      if (it == m_Cells.end()) {
+        continue;
+      }
+      for (uint32_t id : it->second) {
+        if (m_QueryStamps[id] == m_CurrentStamp) {
+          continue;
+        }
+        m_QueryStamps[id] = m_CurrentStamp;
+
+        const glm::vec4& bounds = m_Entries[id].bounds;
+        if (bounds.x <= rect.z && bounds.z >= rect.x &&
+            bounds.y <= rect.w && bounds.w >= rect.y) {
+          results.push_back(id);
+        }
+      }
+    }
+  }
+}
+
+void SpatialGrid::AddToCells(uint32_t id, glm::ivec2 minCell, glm::ivec2 maxCell) {
+  for (int y = minCell.y; y <= maxCell.y; y++) {
+    for (int x = minCell.x; x <= maxCell.x; x++) {
+      m_Cells[CellKey(x, y)].push_back(id);
+    }
+  }
+}
+
+void SpatialGrid::RemoveFromCells(uint32_t id, glm::ivec2 minCell, glm::ivec2 maxCell) {
+  for (int y = minCell.y; y <= maxCell.y; y++) {
+    for (int x = minCell.x; x <= maxCell.x; x++) {
+      auto it = m_Cells.find(CellKey(x, y));
+      if (it == m_Cells.end()) {
+        continue;
+      }
+      std::vector<uint32_t>& ids = it->second;
+      auto found = std::find(ids.begin(), ids.end(), id);
+      if (found != ids.end()) {
+        // Order inside a cell does not matter
+        *found = ids.back();
+        ids.pop_back();
+      }
+      if (ids.empty()) {
+        m_Cells.erase(it);
+      }
+    }
+  }
+}
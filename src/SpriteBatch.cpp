@@ -0,0 +1,305 @@
+#include "SpriteBatch.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include <cstddef>
+
+SpriteBatch::SpriteBatch()
+    : m_Mode(SpriteBatchMode::Vertices), m_TexturedShader(nullptr), m_SolidShader(nullptr),
+      m_VAO(0), m_VertexStream(nullptr), m_IndexStream(nullptr), m_MaxVertices(0),
+      m_MaxIndices(0), m_Vertices(nullptr), m_Indices(nullptr), m_VertexOffset(0),
+      m_IndexOffset(0), m_VertexCount(0), m_IndexCount(0), m_VertexCapacity(0),
+      m_IndexCapacity(0), m_CurrentTexture(0), m_AnimationClips(nullptr),
+      m_InstancedTexturedShader(nullptr), m_InstancedSolidShader(nullptr), m_QuadVAO(0),
+      m_QuadIndexCount(0), m_MaxInstances(0), m_Instances(nullptr), m_InstanceOffset(0),
+      m_InstanceCount(0), m_InstanceCapacity(0), m_DrawCalls(0), m_Sprites(0) {}
+
+SpriteBatch::~SpriteBatch() {
+  Cleanup();
+}
+
+bool SpriteBatch::Init(Shader* texturedShader, Shader* solidShader, StreamBuffer* vertexStream,
+                       StreamBuffer* indexStream, int maxVertices) {
+  m_TexturedShader = texturedShader;
+  m_SolidShader = solidShader;
+  m_VertexStream = vertexStream;
+  m_IndexStream = indexStream;
+  m_MaxVertices = maxVertices;
+  // Every sprite is a quad: 6 indices per 4 vertices
+  m_MaxIndices = maxVertices / 4 * 6;
+
+  glGenVertexArrays(1, &m_VAO);
+
+  GLStateCache* state = GLStateCache::Get();
+  state->BindVertexArray(m_VAO);
+
+  // Attributes start at offset 0 of the vertex stream; each run picks its
+  // place in the ring with glDrawElementsBaseVertex
+  state->BindBuffer(GL_ARRAY_BUFFER, m_VertexStream->GetID());
+  state->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexStream->GetID());
+
+  // Position attribute
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+                        (void *)offsetof(SpriteVertex, position));
+  glEnableVertexAttribArray(0);
+
+  // Texture Coord attribute
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+                        (void *)offsetof(SpriteVertex, texCoord));
+  glEnableVertexAttribArray(1);
+
+  // Color attribute
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+                        (void *)offsetof(SpriteVertex, color));
+  glEnableVertexAttribArray(2);
+
+  // Shape attribute
+  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+                        (void *)offsetof(SpriteVertex, shape));
+  glEnableVertexAttribArray(3);
+
+  state->BindVertexArray(0);
+  return true;
+}
+
+void SpriteBatch::InitInstancing(Shader* texturedShader, Shader* solidShader,
+                                 GLuint quadVAO, int quadIndexCount, int maxInstances) {
+  m_InstancedTexturedShader = texturedShader;
+  m_InstancedSolidShader = solidShader;
+  m_QuadVAO = quadVAO;
+  m_QuadIndexCount = quadIndexCount;
+  m_MaxInstances = maxInstances;
+}
+
+void SpriteBatch::SetInstanceAttributes(GLintptr offset) {
+  // Position/size attribute
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance),
+                        (void *)(offset + offsetof(SpriteInstance, positionSize)));
+  // Texture offset/scale attribute
+  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance),
+                        (void *)(offset + offsetof(SpriteInstance, textureOffsetScale)));
+  // Color attribute
+  glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance),
+                        (void *)(offset + offsetof(SpriteInstance, color)));
+}
+
+void SpriteBatch::Cleanup() {
+  if (m_VAO != 0) {
+    GLStateCache::Get()->DeleteVertexArray(m_VAO);
+    m_VAO = 0;
+  }
+  m_Vertices = nullptr;
+  m_Indices = nullptr;
+  m_Instances = nullptr;
+  m_VertexCount = m_IndexCount = m_InstanceCount = 0;
+  m_VertexCapacity = m_IndexCapacity = m_InstanceCapacity = 0;
+}
+
+void SpriteBatch::Begin() {
+  m_CurrentTexture = 0;
+  m_VertexCount = 0;
+  m_IndexCount = 0;
+  m_InstanceCount = 0;
+}
+
+void SpriteBatch::End() {
+  Flush();
+}
+
+void SpriteBatch::ResetCounters() {
+  m_DrawCalls = 0;
+  m_Sprites = 0;
+}
+
+bool SpriteBatch::Reserve(GLuint texture, int vertexCount, int indexCount) {
+  // A new texture or a full mapping ends the current run
+  if (texture != m_CurrentTexture ||
+      m_VertexCount + vertexCount > m_VertexCapacity ||
+      m_IndexCount + indexCount > m_IndexCapacity) {
+    Flush();
+    m_CurrentTexture = texture;
+  }
+
+  // Open the run lazily, asking only for this sprite and taking the rest of
+  // the regions up to the maximum; vertex offsets must be whole vertices for
+  // the base vertex
+  if (!m_Vertices) {
+    size_t vertexBytes = 0, indexBytes = 0;
+    m_Vertices = (SpriteVertex*)m_VertexStream->Map(
+        vertexCount * sizeof(SpriteVertex), m_MaxVertices * sizeof(SpriteVertex),
+        sizeof(SpriteVertex), m_VertexOffset, vertexBytes);
+    m_Indices = (unsigned int*)m_IndexStream->Map(
+        indexCount * sizeof(unsigned int), m_MaxIndices * sizeof(unsigned int),
+        sizeof(unsigned int), m_IndexOffset, indexBytes);
+    if (!m_Vertices || !m_Indices) {
+      m_VertexStream->Commit(0);
+      m_IndexStream->Commit(0);
+      m_Vertices = nullptr;
+      m_Indices = nullptr;
+      return false;
+    }
+    m_VertexCapacity = (int)(vertexBytes / sizeof(SpriteVertex));
+    m_IndexCapacity = (int)(indexBytes / sizeof(unsigned int));
+  }
+  return true;
+}
+
+bool SpriteBatch::ReserveInstance(GLuint texture) {
+  // Texture 0 selects the solid shader variant, so solid and textured
+  // sprites form separate runs; solid shapes of any kind share one
+  if (texture != m_CurrentTexture || m_InstanceCount >= m_InstanceCapacity) {
+    Flush();
+    m_CurrentTexture = texture;
+  }
+
+  if (!m_Instances) {
+    size_t instanceBytes = 0;
+    m_Instances = (SpriteInstance*)m_VertexStream->Map(
+        sizeof(SpriteInstance), m_MaxInstances * sizeof(SpriteInstance), sizeof(float),
+        m_InstanceOffset, instanceBytes);
+    m_InstanceCapacity = (int)(instanceBytes / sizeof(SpriteInstance));
+  }
+  return m_Instances != nullptr;
+}
+
+void SpriteBatch::SubmitQuad(GLuint texture, glm::vec2 position, glm::vec2 size,
+                             glm::vec4 uvRect, glm::vec4 color) {
+  if (m_Mode == SpriteBatchMode::Instanced) {
+    if (!ReserveInstance(texture)) {
+      return;
+    }
+    m_Instances[m_InstanceCount++] = {glm::vec4(position, size), uvRect, color};
+    m_Sprites++;
+    return;
+  }
+
+  if (!Reserve(texture, 4, 6)) {
+    return;
+  }
+
+  // GameObject position is the quad center; texture v grows downwards like screen y
+  glm::vec2 halfSize = size * 0.5f;
+  float left = position.x - halfSize.x;
+  float right = position.x + halfSize.x;
+  float top = position.y - halfSize.y;
+  float bottom = position.y + halfSize.y;
+
+  if (texture != 0 && m_AnimationClips && IsAnimationParams(uvRect)) {
+    uvRect = m_AnimationClips->Evaluate((int)uvRect.x, uvRect.y);
+  }
+  float u0 = uvRect.x;
+  float v0 = uvRect.y;
+  float u1 = uvRect.x + uvRect.z;
+  float v1 = uvRect.y + uvRect.w;
+  glm::vec4 shape(0.0f);
+  if (texture == 0) {
+    // Solid sprites carry center-relative coordinates for the shape's
+    // distance function instead of texture coordinates
+    u0 = -halfSize.x;
+    v0 = -halfSize.y;
+    u1 = halfSize.x;
+    v1 = halfSize.y;
+    shape = glm::vec4(glm::abs(halfSize), uvRect.x, uvRect.y);
+  }
+
+  // Mapped memory may be write-combined: write sequentially, never read
+  unsigned int base = (unsigned int)m_VertexCount;
+  SpriteVertex* vertex = m_Vertices + m_VertexCount;
+  vertex[0] = {glm::vec2(right, bottom), glm::vec2(u1, v1), color, shape};
+  vertex[1] = {glm::vec2(right, top), glm::vec2(u1, v0), color, shape};
+  vertex[2] = {glm::vec2(left, top), glm::vec2(u0, v0), color, shape};
+  vertex[3] = {glm::vec2(left, bottom), glm::vec2(u0, v1), color, shape};
+  m_VertexCount += 4;
+
+  unsigned int* index = m_Indices + m_IndexCount;
+  index[0] = base + 0;
+  index[1] = base + 1;
+  index[2] = base + 3;
+  index[3] = base + 1;
+  index[4] = base + 2;
+  index[5] = base + 3;
+  m_IndexCount += 6;
+
+  m_Sprites++;
+}
+
+void SpriteBatch::SubmitShape(SpriteShape shape, glm::vec2 position, glm::vec2 size,
+                              glm::vec4 color, float parameter) {
+  SubmitQuad(0, position, size, ShapeParams(shape, parameter), color);
+}
+
+void SpriteBatch::Flush() {
+  if (m_Mode == SpriteBatchMode::Instanced) {
+    FlushInstances();
+  } else {
+    FlushVertices();
+  }
+}
+
+void SpriteBatch::FlushVertices() {
+  if (!m_Vertices) {
+    return;
+  }
+
+  // Hand the written part of the run back to the streams before drawing
+  m_VertexStream->Commit(m_VertexCount * sizeof(SpriteVertex));
+  m_IndexStream->Commit(m_IndexCount * sizeof(unsigned int));
+  m_Vertices = nullptr;
+  m_Indices = nullptr;
+  m_VertexCapacity = m_IndexCapacity = 0;
+
+  if (m_IndexCount > 0) {
+    GLStateCache* state = GLStateCache::Get();
+    if (m_CurrentTexture != 0) {
+      m_TexturedShader->Use();
+      state->BindTexture(m_CurrentTexture);
+    } else {
+      m_SolidShader->Use();
+    }
+    state->BindVertexArray(m_VAO);
+
+    glDrawElementsBaseVertex(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT,
+                             (void *)m_IndexOffset,
+                             (GLint)(m_VertexOffset / sizeof(SpriteVertex)));
+    m_DrawCalls++;
+    RenderStats::Get()->AddDrawCall(m_IndexCount / 3);
+  }
+
+  m_VertexCount = 0;
+  m_IndexCount = 0;
+}
+
+void SpriteBatch::FlushInstances() {
+  if (!m_Instances) {
+    return;
+  }
+
+  m_VertexStream->Commit(m_InstanceCount * sizeof(SpriteInstance));
+  m_Instances = nullptr;
+  m_InstanceCapacity = 0;
+
+  if (m_InstanceCount > 0) {
+    DrawInstances(m_CurrentTexture, m_InstanceOffset, m_InstanceCount);
+  }
+
+  m_InstanceCount = 0;
+}
+
+void SpriteBatch::DrawInstances(GLuint texture, GLintptr offset, int count) {
+  GLStateCache* state = GLStateCache::Get();
+  if (texture != 0) {
+    m_InstancedTexturedShader->Use();
+    state->BindTexture(texture);
+  } else {
+    m_InstancedSolidShader->Use();
+  }
+  state->BindVertexArray(m_QuadVAO);
+
+  // GL 3.3 has no base instance, so point the instance attributes at this
+  // run's records instead
+  state->BindBuffer(GL_ARRAY_BUFFER, m_VertexStream->GetID());
+  SetInstanceAttributes(offset);
+
+  glDrawElementsInstanced(GL_TRIANGLES, m_QuadIndexCount, GL_UNSIGNED_INT, 0, count);
+  m_DrawCalls++;
+  RenderStats::Get()->AddDrawCall(m_QuadIndexCount / 3 * count);
+}
@@ -0,0 +1,160 @@
+#include "StreamBuffer.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+StreamBuffer::StreamBuffer()
+    : m_ID(0), m_Persistent(false), m_Mapping(nullptr), m_RegionSize(0),
+      m_RegionCount(0), m_Size(0), m_Region(0), m_Head(0), m_Pending(SIZE_MAX),
+      m_Fences{nullptr, nullptr, nullptr, nullptr} {}
+
+StreamBuffer::~StreamBuffer() {
+  Cleanup();
+}
+
+bool StreamBuffer::Init(size_t regionSize, int regionCount) {
+  if (regionCount < 2 || regionCount > kMaxRegions) {
+    std::cerr << "StreamBuffer needs 2-" << kMaxRegions << " regions" << std::endl;
+    return false;
+  }
+  m_RegionSize = regionSize;
+  m_RegionCount = regionCount;
+  m_Size = regionSize * regionCount;
+  m_Region = 0;
+  m_Head = 0;
+
+  glGenBuffers(1, &m_ID);
+  GLStateCache::Get()->BindBuffer(GL_ARRAY_BUFFER, m_ID);
+
+  m_Persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+  if (m_Persistent) {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_ARRAY_BUFFER, m_Size, nullptr, flags);
+    m_Mapping = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, m_Size, flags);
+    if (!m_Mapping) {
+      std::cerr << "Failed to map stream buffer persistently" << std::endl;
+      return false;
+    }
+  } else {
+    glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_STREAM_DRAW);
+  }
+
+  std::cout << "Stream buffer: " << (m_Size / 1024) << " KB, "
+            << (m_Persistent ? "persistent mapping" : "orphaning") << std::endl;
+  return true;
+}
+
+void StreamBuffer::Cleanup() {
+  if (m_ID == 0) {
+    return;
+  }
+  for (GLsync& fence : m_Fences) {
+    if (fence) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+  GLStateCache* state = GLStateCache::Get();
+  if (m_Mapping) {
+    state->BindBuffer(GL_ARRAY_BUFFER, m_ID);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    m_Mapping = nullptr;
+  }
+  state->DeleteBuffer(m_ID);
+  m_ID = 0;
+}
+
+void* StreamBuffer::Map(size_t minBytes, size_t maxBytes, size_t alignment, GLintptr& offset,
+                         size_t& mappedBytes) {
+  mappedBytes = 0;
+  maxBytes = std::max(minBytes, maxBytes);
+  if (m_ID == 0 || minBytes + alignment > m_RegionSize) {
+    return nullptr;
+  }
+  return m_Persistent ? MapPersistent(minBytes, maxBytes, alignment, offset, mappedBytes)
+                      : MapOrphaned(minBytes, maxBytes, alignment, offset, mappedBytes);
+}
+
+void* StreamBuffer::MapPersistent(size_t minBytes, size_t maxBytes, size_t alignment,
+                                  GLintptr& offset, size_t& mappedBytes) {
+  size_t aligned = (m_Head + alignment - 1) / alignment * alignment;
+  size_t regionEnd = (m_Region + 1) * m_RegionSize;
+
+  if (aligned + minBytes > regionEnd) {
+    // Everything drawn from this region has been issued; fence it and move
+    // on to the next one once the GPU is done with that
+    m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_Region = (m_Region + 1) % m_RegionCount;
+    WaitForRegion(m_Region);
+    m_Head = m_Region * m_RegionSize;
+    aligned = (m_Head + alignment - 1) / alignment * alignment;
+    regionEnd = (m_Region + 1) * m_RegionSize;
+  }
+
+  m_Pending = aligned;
+  offset = (GLintptr)aligned;
+  mappedBytes = std::min(maxBytes, regionEnd - aligned);
+  return m_Mapping + aligned;
+}
+
+void* StreamBuffer::MapOrphaned(size_t minBytes, size_t maxBytes, size_t alignment,
+                                GLintptr& offset, size_t& mappedBytes) {
+  size_t aligned = (m_Head + alignment - 1) / alignment * alignment;
+
+  GLStateCache::Get()->BindBuffer(GL_ARRAY_BUFFER, m_ID);
+  if (aligned + minBytes > m_Size) {
+    // Fresh storage; the driver keeps the old one alive for pending draws
+    glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_STREAM_DRAW);
+    aligned = 0;
+  }
+
+  // Never more than a region, so one mapping stays a bounded range
+  size_t bytes = std::min({maxBytes, m_RegionSize, m_Size - aligned});
+  void* pointer = glMapBufferRange(GL_ARRAY_BUFFER, aligned, bytes,
+                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                                   GL_MAP_UNSYNCHRONIZED_BIT);
+  if (!pointer) {
+    return nullptr;
+  }
+  m_Pending = aligned;
+  offset = (GLintptr)aligned;
+  mappedBytes = bytes;
+  return pointer;
+}
+
+void StreamBuffer::Commit(size_t usedBytes) {
+  if (m_Pending == SIZE_MAX) {
+    return;
+  }
+  if (!m_Persistent) {
+    GLStateCache::Get()->BindBuffer(GL_ARRAY_BUFFER, m_ID);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+  }
+  m_Head = m_Pending + usedBytes;
+  m_Pending = SIZE_MAX;
+  if (RenderStats* stats = RenderStats::Get()) {
+    stats->AddStreamedBytes(usedBytes);
+  }
+}
+
+void StreamBuffer::WaitForRegion(int region) {
+  GLsync fence = m_Fences[region];
+  if (!fence) {
+    return;
+  }
+
+  // Flush once so the fence is guaranteed to signal, then block in 1 ms steps
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  while (true) {
+    GLenum result = glClientWaitSync(fence, flags, 1000000);
+    if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED ||
+        result == GL_WAIT_FAILED) {
+      break;
+    }
+    flags = 0;
+  }
+  glDeleteSync(fence);
+  m_Fences[region] = nullptr;
+}
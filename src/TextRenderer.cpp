@@ -1,147 +1,192 @@
 #include "TextRenderer.h"
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
+#include "RenderStats.h"
 #include <iostream>
 
-TextRenderer::TextRenderer() 
-    : m_Font(nullptr), m_TextTexture(0), m_TextWidth(0), m_TextHeight(0) {}
+TextRenderer::TextRenderer()
+    : m_Font(nullptr), m_Atlas(nullptr), m_LineHeight(0) {}
 
 TextRenderer::~TextRenderer() {
   Cleanup();
 }
 
 bool TextRenderer::LoadFont(const char* fontPath, int fontSize) {
+  Cleanup();
+
   m_Font = TTF_OpenFont(fontPath, fontSize);
+  return InitFont(fontPath);
+}
+
+bool TextRenderer::LoadFontMemory(const void* data, size_t size, int fontSize,
+                                  const char* name) {
+  Cleanup();
+
+  // SDL_ttf reads the font lazily, straight from the caller's memory
+  m_Font = TTF_OpenFontRW(SDL_RWFromConstMem(data, (int)size), 1, fontSize);
+  return InitFont(name);
+}
+
+bool TextRenderer::InitFont(const char* name) {
   if (m_Font == nullptr) {
     std::cerr << "Failed to load font! SDL_ttf Error: " << TTF_GetError() << std::endl;
     return false;
   }
-  std::cout << "Font loaded: " << fontPath << std::endl;
+  std::cout << "Font loaded: " << name << std::endl;
+
+  m_LineHeight = TTF_FontHeight(m_Font);
+  m_Atlas = new TextureAtlas(1024, 1);
+  m_Glyphs.assign(256, Glyph{false, 0, glm::vec4(0.0f), 0, 0, 0});
+
+  // Rasterize printable ASCII up front, other Latin-1 glyphs on first use
+  std::vector<unsigned char> codes;
+  for (int code = kFirstPrecached; code <= kLastPrecached; code++) {
+    codes.push_back((unsigned char)code);
+  }
+  if (!RasterizeGlyphs(codes)) {
+    std::cerr << "Failed to build glyph atlas for " << name << std::endl;
+    return false;
+  }
+  BuildKerningTable();
   return true;
 }
 
-void TextRenderer::CreateTextTexture(const std::string& text) {
-  if (m_Font == nullptr) {
-    return;
-  }
+bool TextRenderer::RasterizeGlyphs(const std::vector<unsigned char>& codes) {
+  // Glyphs are rendered white so SpriteBatch color tints them
+  SDL_Color white = {255, 255, 255, 255};
+  std::vector<SDL_Surface*> surfaces;
+  std::vector<AtlasImage> images;
+  std::vector<unsigned char> imageCodes;
+
+  for (unsigned char code : codes) {
+    Glyph& glyph = m_Glyphs[code];
+    glyph.cached = true;
+
+    int minX, maxX, minY, maxY;
+    if (!TTF_GlyphIsProvided(m_Font, code) ||
+        TTF_GlyphMetrics(m_Font, code, &minX, &maxX, &minY, &maxY, &glyph.advance) != 0) {
+      continue;
+    }
 
-  // Render text to SDL surface with black text on white background
-  SDL_Color textColor = {0, 0, 0, 255}; // Black
-  SDL_Color bgColor = {255, 255, 255, 255}; // White
-  SDL_Surface* textSurface = TTF_RenderText_Shaded(m_Font, text.c_str(), textColor, bgColor);
-  
-  if (textSurface == nullptr) {
-    std::cerr << "Unable to render text surface! SDL_ttf Error: " << TTF_GetError() << std::endl;
-    return;
+    // Same surface TTF_RenderText would produce for this single character:
+    // pen at x = 0, one line high
+    SDL_Surface* surface = TTF_RenderGlyph_Blended(m_Font, code, white);
+    if (surface == nullptr) {
+      continue;
+    }
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+    if (converted == nullptr) {
+      continue;
+    }
+
+    glyph.width = converted->w;
+    glyph.height = converted->h;
+    surfaces.push_back(converted);
+    images.push_back({(const unsigned char*)converted->pixels, converted->w,
+                      converted->h, converted->pitch});
+    imageCodes.push_back(code);
   }
 
-  m_TextWidth = textSurface->w;
-  m_TextHeight = textSurface->h;
+  bool packed = true;
+  if (!images.empty()) {
+    GLuint page = 0;
+    std::vector<glm::vec4> rects;
+    packed = m_Atlas->Add(images, page, rects);
+    for (size_t i = 0; packed && i < imageCodes.size(); i++) {
+      m_Glyphs[imageCodes[i]].page = page;
+      m_Glyphs[imageCodes[i]].uvRect = rects[i];
+    }
+  }
 
-  // Delete old texture if exists
-  if (m_TextTexture != 0) {
-    glDeleteTextures(1, &m_TextTexture);
+  for (SDL_Surface* surface : surfaces) {
+    SDL_FreeSurface(surface);
   }
+  return packed;
+}
 
-  // Create OpenGL texture
-  glGenTextures(1, &m_TextTexture);
-  glBindTexture(GL_TEXTURE_2D, m_TextTexture);
-
-  // Set texture parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  // Convert SDL surface to OpenGL texture
-  // TTF_RenderText_Solid creates a surface with format SDL_PIXELFORMAT_RGBA32 or similar
-  // We need to determine the correct format
-  GLenum textureFormat = GL_RGBA;
-  GLenum dataType = GL_UNSIGNED_BYTE;
-  
-  // Check surface format and convert if necessary
-  if (textSurface->format->format == SDL_PIXELFORMAT_RGBA32 || 
-      textSurface->format->format == SDL_PIXELFORMAT_ABGR8888) {
-    textureFormat = GL_RGBA;
-  } else if (textSurface->format->format == SDL_PIXELFORMAT_BGRA32 ||
-             textSurface->format->format == SDL_PIXELFORMAT_ARGB8888) {
-    textureFormat = GL_BGRA;
-  } else {
-    // Default: assume RGBA and let SDL convert if needed
-    SDL_Surface* convertedSurface = SDL_ConvertSurfaceFormat(textSurface, SDL_PIXELFORMAT_RGBA32, 0);
-    if (convertedSurface) {
-      SDL_FreeSurface(textSurface);
-      textSurface = convertedSurface;
-      textureFormat = GL_RGBA;
+void TextRenderer::BuildKerningTable() {
+  m_Kerning.assign(kPrecachedCount * kPrecachedCount, 0);
+  for (int previous = 0; previous < kPrecachedCount; previous++) {
+    for (int code = 0; code < kPrecachedCount; code++) {
+      m_Kerning[previous * kPrecachedCount + code] = (short)TTF_GetFontKerningSizeGlyphs(
+          m_Font, (Uint16)(previous + kFirstPrecached), (Uint16)(code + kFirstPrecached));
     }
   }
+}
 
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textSurface->w, textSurface->h, 0,
-               textureFormat, dataType, textSurface->pixels);
-  glGenerateMipmap(GL_TEXTURE_2D);
+int TextRenderer::GetKerning(unsigned char previous, unsigned char code) const {
+  if (previous >= kFirstPrecached && previous <= kLastPrecached &&
+      code >= kFirstPrecached && code <= kLastPrecached) {
+    return m_Kerning[(previous - kFirstPrecached) * kPrecachedCount + (code - kFirstPrecached)];
+  }
+  return TTF_GetFontKerningSizeGlyphs(m_Font, previous, code);
+}
 
-  // Free SDL surface
-  SDL_FreeSurface(textSurface);
-  glBindTexture(GL_TEXTURE_2D, 0);
+const TextRenderer::Glyph& TextRenderer::GetGlyph(unsigned char code) {
+  if (!m_Glyphs[code].cached) {
+    RasterizeGlyphs({code});
+  }
+  return m_Glyphs[code];
 }
 
-void TextRenderer::RenderText(const std::string& text, int x, int y,
-                              GLuint shaderProgram, GLuint VAO,
-                              int screenWidth, int screenHeight) {
+glm::vec2 TextRenderer::MeasureText(const std::string& text) {
   if (m_Font == nullptr) {
-    return;
+    return glm::vec2(0.0f);
   }
 
-  // Create texture for this text
-  CreateTextTexture(text);
+  int penX = 0;
+  unsigned char previous = 0;
+  for (char c : text) {
+    unsigned char code = (unsigned char)c;
+    if (previous != 0) {
+      penX += GetKerning(previous, code);
+    }
+    penX += GetGlyph(code).advance;
+    previous = code;
+  }
+  return glm::vec2((float)penX, (float)m_LineHeight);
+}
 
-  if (m_TextTexture == 0) {
+void TextRenderer::RenderText(const std::string& text, int x, int y,
+                              SpriteBatch& batch, glm::vec4 color) {
+  if (m_Font == nullptr) {
     return;
   }
 
-  // Use shader program
-  glUseProgram(shaderProgram);
-
-  // Screen space projection (no view matrix, fixed orthographic)
-  glm::mat4 projection = glm::ortho(0.0f, (float)screenWidth, (float)screenHeight, 0.0f, -1.0f, 1.0f);
-  glm::mat4 view = glm::mat4(1.0f); // Identity matrix (no camera movement)
-  
-  // Model matrix - position text at screen coordinates
-  glm::mat4 model = glm::mat4(1.0f);
-  model = glm::translate(model, glm::vec3((float)x, (float)y, 0.0f));
-  model = glm::scale(model, glm::vec3((float)m_TextWidth, (float)m_TextHeight, 1.0f));
-
-  // Set uniforms
-  unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
-  glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-  unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
-  glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-
-  unsigned int projLoc = glGetUniformLocation(shaderProgram, "projection");
-  glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+  glm::vec2 extent = MeasureText(text);
+  glm::vec2 origin((float)x - extent.x * 0.5f, (float)y - extent.y * 0.5f);
 
-  // Set texture mode (not color mode)
-  unsigned int useColorLoc = glGetUniformLocation(shaderProgram, "useColor");
-  glUniform1i(useColorLoc, 0);
-
-  // Bind texture
-  glBindTexture(GL_TEXTURE_2D, m_TextTexture);
+  int penX = 0;
+  int glyphsDrawn = 0;
+  unsigned char previous = 0;
+  for (char c : text) {
+    unsigned char code = (unsigned char)c;
+    if (previous != 0) {
+      penX += GetKerning(previous, code);
+    }
 
-  // Draw
-  glBindVertexArray(VAO);
-  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+    const Glyph& glyph = GetGlyph(code);
+    if (glyph.page != 0) {
+      glyphsDrawn++;
+      glm::vec2 size((float)glyph.width, (float)glyph.height);
+      batch.SubmitQuad(glyph.page, origin + glm::vec2((float)penX, 0.0f) + size * 0.5f,
+                       size, glyph.uvRect, color);
+    }
+    penX += glyph.advance;
+    previous = code;
+  }
+  RenderStats::Get()->AddGlyphsDrawn(glyphsDrawn);
 }
 
 void TextRenderer::Cleanup() {
-  if (m_TextTexture != 0) {
-    glDeleteTextures(1, &m_TextTexture);
-    m_TextTexture = 0;
+  if (m_Atlas != nullptr) {
+    m_Atlas->Cleanup();
+    delete m_Atlas;
+    m_Atlas = nullptr;
   }
+  m_Glyphs.clear();
+  m_Kerning.clear();
   if (m_Font != nullptr) {
     TTF_CloseFont(m_Font);
     m_Font = nullptr;
   }
 }
-
@@ -1,17 +1,24 @@
 #include "Texture.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-Texture::Texture() : ID(0), width(0), height(0), nrChannels(0) {}
+Texture::Texture()
+    : ID(0), width(0), height(0), nrChannels(0), ownsID(true),
+      uvRect(0.0f, 0.0f, 1.0f, 1.0f), cellColumns(0), cellRows(0) {}
 
 Texture::~Texture() { Cleanup(); }
 
 bool Texture::Load(const char *path) {
   glGenTextures(1, &ID);
-  glBindTexture(GL_TEXTURE_2D, ID);
+  GLStateCache::Get()->BindTexture(ID);
 
   // Set texture wrapping/filtering options
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -34,36 +41,177 @@ bool Texture::Load(const char *path) {
 
     glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format,
                  GL_UNSIGNED_BYTE, data);
+    if (RenderStats* stats = RenderStats::Get()) {
+      stats->AddTextureUpload((size_t)width * height * nrChannels);
+    }
     glGenerateMipmap(GL_TEXTURE_2D);
     std::cout << "Texture loaded: " << path << std::endl;
   } else {
     std::cout << "Failed to load texture: " << path << ". Using fallback."
               << std::endl;
+    width = kFallbackSize;
+    height = kFallbackSize;
+    UploadFallback();
+  }
+
+  stbi_image_free(data);
+  return true;
+}
 
-    // Fallback: Checkerboard
-    width = 64;
-    height = 64;
-    std::vector<unsigned char> checkImage(width * height * 3);
-    for (int y = 0; y < height; y++) {
-      for (int x = 0; x < width; x++) {
-        unsigned char color = ((((y / 8) + (x / 8)) % 2) == 0) ? 0 : 255;
-        int index = (y * width + x) * 3;
-        checkImage[index] = color;     // R
-        checkImage[index + 1] = color; // G
-        checkImage[index + 2] = color; // B
+bool Texture::LoadIntoAtlas(const char *path, TextureAtlas& atlas,
+                            int cellWidth, int cellHeight) {
+  // Atlas pages are RGBA, so always decode to 4 channels
+  int imageWidth = 0, imageHeight = 0;
+  unsigned char *data = stbi_load(path, &imageWidth, &imageHeight, &nrChannels, 4);
+  if (!data) {
+    // Standalone checkerboard fallback
+    return Load(path);
+  }
+  bool loaded = LoadIntoAtlas(data, imageWidth, imageHeight, 1, path, atlas, cellWidth,
+                              cellHeight);
+  stbi_image_free(data);
+  return loaded;
+}
+
+bool Texture::LoadIntoAtlas(const unsigned char *rgba, int imageWidth, int imageHeight,
+                            int levels, const char *name, TextureAtlas& atlas,
+                            int cellWidth, int cellHeight) {
+  width = imageWidth;
+  height = imageHeight;
+  nrChannels = 4;
+
+  std::vector<AtlasImage> images;
+  if (cellWidth > 0 && cellHeight > 0) {
+    cellColumns = width / cellWidth;
+    cellRows = height / cellHeight;
+    for (int row = 0; row < cellRows; row++) {
+      for (int column = 0; column < cellColumns; column++) {
+        const unsigned char *cell = rgba + (row * cellHeight * width + column * cellWidth) * 4;
+        images.push_back({cell, cellWidth, cellHeight, width * 4});
       }
     }
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB,
-                 GL_UNSIGNED_BYTE, checkImage.data());
-    glGenerateMipmap(GL_TEXTURE_2D);
+  } else {
+    images.push_back({rgba, width, height, width * 4});
   }
 
-  stbi_image_free(data);
+  GLuint pageID = 0;
+  std::vector<glm::vec4> rects;
+  bool packed = !images.empty() && atlas.Add(images, pageID, rects);
+
+  if (!packed) {
+    // Larger than an atlas page, keep it as its own texture
+    cellColumns = 0;
+    cellRows = 0;
+    return LoadPixels(rgba, width, height, levels, name);
+  }
+
+  ID = pageID;
+  ownsID = false;
+  if (cellColumns > 0) {
+    cellRects = rects;
+  } else {
+    uvRect = rects[0];
+  }
+  std::cout << "Texture packed into atlas: " << name << std::endl;
+  return true;
+}
+
+bool Texture::LoadPixels(const unsigned char *rgba, int imageWidth, int imageHeight,
+                         int levels, const char *name) {
+  Cleanup();
+  width = imageWidth;
+  height = imageHeight;
+  nrChannels = 4;
+  ownsID = true;
+  uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+  glGenTextures(1, &ID);
+  GLStateCache::Get()->BindTexture(ID);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  // Levels are stored back to back, each half the size of the previous
+  size_t bytes = 0;
+  int levelWidth = width, levelHeight = height;
+  for (int level = 0; level < levels; level++) {
+    glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, levelWidth, levelHeight, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, rgba + bytes);
+    bytes += (size_t)levelWidth * levelHeight * 4;
+    levelWidth = std::max(levelWidth / 2, 1);
+    levelHeight = std::max(levelHeight / 2, 1);
+  }
+  if (levels <= 1) {
+    glGenerateMipmap(GL_TEXTURE_2D);
+  }
+  if (RenderStats* stats = RenderStats::Get()) {
+    stats->AddTextureUpload(bytes);
+  }
+  std::cout << "Texture loaded: " << name << std::endl;
   return true;
 }
 
-void Texture::Bind() { glBindTexture(GL_TEXTURE_2D, ID); }
+glm::vec4 Texture::MapUV(const glm::vec4& rect) const {
+  if (cellRects.empty()) {
+    return glm::vec4(uvRect.x + rect.x * uvRect.z, uvRect.y + rect.y * uvRect.w,
+                     rect.z * uvRect.z, rect.w * uvRect.w);
+  }
+
+  // Cells were packed separately, so remap relative to the cell that
+  // contains the rect's center
+  float cellU = 1.0f / cellColumns;
+  float cellV = 1.0f / cellRows;
+  int column = glm::clamp((int)((rect.x + rect.z * 0.5f) / cellU), 0, cellColumns - 1);
+  int row = glm::clamp((int)((rect.y + rect.w * 0.5f) / cellV), 0, cellRows - 1);
+  const glm::vec4& cell = cellRects[row * cellColumns + column];
+
+  float offsetX = (rect.x - column * cellU) / cellU;
+  float offsetY = (rect.y - row * cellV) / cellV;
+  return glm::vec4(cell.x + offsetX * cell.z, cell.y + offsetY * cell.w,
+                   rect.z / cellU * cell.z, rect.w / cellV * cell.w);
+}
+
+void Texture::Bind() { GLStateCache::Get()->BindTexture(ID); }
+
+void Texture::Unbind() { GLStateCache::Get()->BindTexture(0); }
+
+void Texture::Wrap(GLuint id, int textureWidth, int textureHeight) {
+  Cleanup();
+  ID = id;
+  ownsID = false;
+  width = textureWidth;
+  height = textureHeight;
+  uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+  cellRects.clear();
+}
+
+void Texture::Adopt(GLuint id, int textureWidth, int textureHeight) {
+  Wrap(id, textureWidth, textureHeight);
+  ownsID = true;
+}
 
-void Texture::Unbind() { glBindTexture(GL_TEXTURE_2D, 0); }
+void Texture::UploadFallback() {
+  // Checkerboard
+  std::vector<unsigned char> checkImage(kFallbackSize * kFallbackSize * 3);
+  for (int y = 0; y < kFallbackSize; y++) {
+    for (int x = 0; x < kFallbackSize; x++) {
+      unsigned char color = ((((y / 8) + (x / 8)) % 2) == 0) ? 0 : 255;
+      int index = (y * kFallbackSize + x) * 3;
+      checkImage[index] = color;     // R
+      checkImage[index + 1] = color; // G
+      checkImage[index + 2] = color; // B
+    }
+  }
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, kFallbackSize, kFallbackSize, 0, GL_RGB,
+               GL_UNSIGNED_BYTE, checkImage.data());
+  glGenerateMipmap(GL_TEXTURE_2D);
+}
 
-void Texture::Cleanup() { glDeleteTextures(1, &ID); }
+void Texture::Cleanup() {
+  // Atlas pages are owned by the TextureAtlas
+  if (ownsID && ID != 0) {
+    GLStateCache::Get()->DeleteTexture(ID);
+  }
+  ID = 0;
+}
@@ -0,0 +1,205 @@
+#include "TextureAtlas.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+TextureAtlas::TextureAtlas(int pageSize, int padding)
+    : m_PageSize(pageSize), m_Padding(padding) {}
+
+TextureAtlas::~TextureAtlas() {
+  Cleanup();
+}
+
+bool TextureAtlas::Add(const std::vector<AtlasImage>& images, GLuint& pageID,
+                       std::vector<glm::vec4>& uvRects) {
+  // Try existing pages on a copy of their skyline, commit only if the whole
+  // group fits so a sprite sheet never ends up split across pages
+  std::vector<glm::ivec2> positions;
+  Page* target = nullptr;
+  for (Page& page : m_Pages) {
+    std::vector<SkylineNode> skyline = page.skyline;
+    if (PackGroup(skyline, images, positions)) {
+      page.skyline = skyline;
+      target = &page;
+      break;
+    }
+  }
+
+  if (!target) {
+    Page page;
+    page.skyline.push_back({0, 0, m_PageSize});
+    if (!PackGroup(page.skyline, images, positions)) {
+      return false;
+    }
+    page.ID = CreatePage();
+    m_Pages.push_back(page);
+    target = &m_Pages.back();
+  }
+
+  pageID = target->ID;
+  uvRects.clear();
+  float pageSize = (float)m_PageSize;
+  for (size_t i = 0; i < images.size(); i++) {
+    Upload(target->ID, images[i], positions[i]);
+    uvRects.push_back(glm::vec4((positions[i].x + m_Padding) / pageSize,
+                                (positions[i].y + m_Padding) / pageSize,
+                                images[i].width / pageSize,
+                                images[i].height / pageSize));
+  }
+  return true;
+}
+
+void TextureAtlas::Cleanup() {
+  for (Page& page : m_Pages) {
+    GLStateCache::Get()->DeleteTexture(page.ID);
+  }
+  m_Pages.clear();
+}
+
+bool TextureAtlas::PackGroup(std::vector<SkylineNode>& skyline,
+                             const std::vector<AtlasImage>& images,
+                             std::vector<glm::ivec2>& positions) const {
+  positions.assign(images.size(), glm::ivec2(0));
+
+  // Tallest first packs tighter with a skyline
+  std::vector<size_t> order(images.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&images](size_t a, size_t b) {
+    return images[a].height > images[b].height;
+  });
+
+  for (size_t i : order) {
+    int width = images[i].width + 2 * m_Padding;
+    int height = images[i].height + 2 * m_Padding;
+    if (!Insert(skyline, width, height, positions[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TextureAtlas::Insert(std::vector<SkylineNode>& skyline, int width, int height,
+                          glm::ivec2& position) const {
+  // Bottom-left heuristic: lowest resulting top edge, then narrowest node
+  int bestY = INT_MAX;
+  int bestWidth = INT_MAX;
+  size_t bestIndex = skyline.size();
+  for (size_t i = 0; i < skyline.size(); i++) {
+    int y = Fit(skyline, i, width, height);
+    if (y < 0) {
+      continue;
+    }
+    if (y + height < bestY || (y + height == bestY && skyline[i].width < bestWidth)) {
+      bestY = y + height;
+      bestWidth = skyline[i].width;
+      bestIndex = i;
+      position = glm::ivec2(skyline[i].x, y);
+    }
+  }
+  if (bestIndex == skyline.size()) {
+    return false;
+  }
+
+  // Raise the skyline under the new rect and trim the nodes it covers
+  SkylineNode node = {position.x, position.y + height, width};
+  skyline.insert(skyline.begin() + bestIndex, node);
+  for (size_t i = bestIndex + 1; i < skyline.size();) {
+    SkylineNode& previous = skyline[i - 1];
+    int shrink = previous.x + previous.width - skyline[i].x;
+    if (shrink <= 0) {
+      break;
+    }
+    skyline[i].x += shrink;
+    skyline[i].width -= shrink;
+    if (skyline[i].width <= 0) {
+      skyline.erase(skyline.begin() + i);
+    } else {
+      break;
+    }
+  }
+
+  // Merge neighbours at the same height
+  for (size_t i = 0; i + 1 < skyline.size();) {
+    if (skyline[i].y == skyline[i + 1].y) {
+      skyline[i].width += skyline[i + 1].width;
+      skyline.erase(skyline.begin() + i + 1);
+    } else {
+      i++;
+    }
+  }
+  return true;
+}
+
+int TextureAtlas::Fit(const std::vector<SkylineNode>& skyline, size_t index,
+                      int width, int height) const {
+  // Returns the y the rect would rest at when placed at node index, or -1
+  int x = skyline[index].x;
+  if (x + width > m_PageSize) {
+    return -1;
+  }
+  int y = 0;
+  int remaining = width;
+  for (size_t i = index; remaining > 0; i++) {
+    if (i >= skyline.size()) {
+      return -1;
+    }
+    y = std::max(y, skyline[i].y);
+    if (y + height > m_PageSize) {
+      return -1;
+    }
+    remaining -= skyline[i].width;
+  }
+  return y;
+}
+
+void TextureAtlas::Upload(GLuint pageID, const AtlasImage& image, glm::ivec2 position) const {
+  // Copy into a padded block, replicating edge texels into the padding
+  int paddedWidth = image.width + 2 * m_Padding;
+  int paddedHeight = image.height + 2 * m_Padding;
+  std::vector<unsigned char> block(paddedWidth * paddedHeight * 4);
+  for (int y = 0; y < paddedHeight; y++) {
+    int srcY = std::clamp(y - m_Padding, 0, image.height - 1);
+    const unsigned char* srcRow = image.pixels + srcY * image.stride;
+    for (int x = 0; x < paddedWidth; x++) {
+      int srcX = std::clamp(x - m_Padding, 0, image.width - 1);
+      std::memcpy(&block[(y * paddedWidth + x) * 4], srcRow + srcX * 4, 4);
+    }
+  }
+
+  GLStateCache::Get()->BindTexture(pageID);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, position.x, position.y, paddedWidth, paddedHeight,
+                  GL_RGBA, GL_UNSIGNED_BYTE, block.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  if (RenderStats* stats = RenderStats::Get()) {
+    stats->AddTextureUpload(block.size());
+  }
+}
+
+GLuint TextureAtlas::CreatePage() const {
+  GLuint ID;
+  glGenTextures(1, &ID);
+  GLStateCache::Get()->BindTexture(ID);
+
+  // Same nearest filtering as individually loaded sprites
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  // Transparent until sprites are packed into it
+  std::vector<unsigned char> clear(m_PageSize * m_PageSize * 4, 0);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_PageSize, m_PageSize, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, clear.data());
+  if (RenderStats* stats = RenderStats::Get()) {
+    stats->AddTextureUpload(clear.size());
+  }
+
+  std::cout << "Atlas page created: " << m_PageSize << "x" << m_PageSize << std::endl;
+  return ID;
+}
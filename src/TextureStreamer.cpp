@@ -0,0 +1,210 @@
+#include "TextureStreamer.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "stb_image.h"
+
+TextureStreamer::TextureStreamer()
+    : m_FallbackID(0), m_UnpackBuffer(0), m_Current{}, m_Uploading(false), m_Decoding(0) {}
+
+TextureStreamer::~TextureStreamer() {
+  Cleanup();
+}
+
+void TextureStreamer::Cleanup() {
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DecodeFinished.wait(lock, [this] { return m_Decoding == 0; });
+    for (Decoded& image : m_Decoded) {
+      FreePixels(image);
+    }
+    m_Decoded.clear();
+  }
+
+  GLStateCache* state = GLStateCache::Get();
+  if (m_Uploading) {
+    state->DeleteTexture(m_Current.id);
+    FreePixels(m_Current.image);
+    m_Current = {};
+    m_Uploading = false;
+  }
+  if (m_UnpackBuffer != 0) {
+    state->DeleteBuffer(m_UnpackBuffer);
+    m_UnpackBuffer = 0;
+  }
+  // Textures still on the fallback only wrap it
+  if (m_FallbackID != 0) {
+    state->DeleteTexture(m_FallbackID);
+    m_FallbackID = 0;
+  }
+}
+
+void TextureStreamer::ShowFallback(Texture* texture) {
+  if (m_FallbackID == 0) {
+    glGenTextures(1, &m_FallbackID);
+    GLStateCache::Get()->BindTexture(m_FallbackID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    Texture::UploadFallback();
+  }
+  texture->Wrap(m_FallbackID, Texture::kFallbackSize, Texture::kFallbackSize);
+}
+
+void TextureStreamer::FreePixels(Decoded& image) {
+  if (image.ownsPixels) {
+    stbi_image_free((void*)image.pixels);
+  }
+  image.pixels = nullptr;
+}
+
+void TextureStreamer::Request(Texture* texture, const std::string& path, ThreadPool* pool) {
+  ShowFallback(texture);
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Decoding++;
+  }
+  if (pool) {
+    pool->SubmitBackground([this, texture, path] { Decode(texture, path); });
+  } else {
+    Decode(texture, path);
+  }
+}
+
+void TextureStreamer::RequestPixels(Texture* texture, const unsigned char* rgba, int width,
+                                    int height, const std::string& name) {
+  ShowFallback(texture);
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Decoded.push_back(Decoded{texture, name, rgba, width, height, false});
+}
+
+void TextureStreamer::Decode(Texture* texture, const std::string& path) {
+  Decoded image;
+  image.texture = texture;
+  image.path = path;
+  int channels = 0;
+  image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &channels, 4);
+  image.ownsPixels = true;
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Decoded.push_back(std::move(image));
+    m_Decoding--;
+  }
+  m_DecodeFinished.notify_all();
+}
+
+int TextureStreamer::Update(double budgetMs) {
+  auto start = std::chrono::steady_clock::now();
+  int finished = 0;
+  do {
+    if (!m_Uploading && !StartUpload()) {
+      break;
+    }
+    UploadStrip();
+    if (m_Current.nextRow >= m_Current.image.height) {
+      FinishUpload();
+      finished++;
+    }
+  } while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+               .count() < budgetMs);
+  return finished;
+}
+
+bool TextureStreamer::StartUpload() {
+  for (;;) {
+    Decoded image;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (m_Decoded.empty()) {
+        return false;
+      }
+      image = std::move(m_Decoded.front());
+      m_Decoded.pop_front();
+    }
+    if (image.pixels) {
+      m_Current.image = std::move(image);
+      break;
+    }
+    // Keeps showing the checkerboard, as Texture::Load does
+    std::cout << "Failed to load texture: " << image.path << ". Using fallback." << std::endl;
+  }
+
+  if (m_UnpackBuffer == 0) {
+    glGenBuffers(1, &m_UnpackBuffer);
+  }
+
+  // Storage only; rows arrive strip by strip
+  glGenTextures(1, &m_Current.id);
+  GLStateCache::Get()->BindTexture(m_Current.id);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_Current.image.width, m_Current.image.height, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  m_Current.nextRow = 0;
+  m_Uploading = true;
+  return true;
+}
+
+void TextureStreamer::UploadStrip() {
+  const Decoded& image = m_Current.image;
+  size_t rowBytes = (size_t)image.width * 4;
+  int rows = std::min(image.height - m_Current.nextRow,
+                      (int)std::max<size_t>(1, kStripBytes / rowBytes));
+  size_t bytes = rowBytes * rows;
+  const unsigned char* source = image.pixels + m_Current.nextRow * rowBytes;
+
+  // Orphaning gives the buffer fresh storage, so the copy never waits for
+  // the previous strip's transfer; glTexSubImage2D then returns without
+  // waiting for this one
+  GLStateCache* state = GLStateCache::Get();
+  state->BindTexture(m_Current.id);
+  state->BindBuffer(GL_PIXEL_UNPACK_BUFFER, m_UnpackBuffer);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+  void* mapping = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (mapping) {
+    std::memcpy(mapping, source, bytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_Current.nextRow, image.width, rows, GL_RGBA,
+                    GL_UNSIGNED_BYTE, nullptr);
+  }
+  // Every other upload passes client memory, so never leave it bound
+  state->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  if (!mapping) {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_Current.nextRow, image.width, rows, GL_RGBA,
+                    GL_UNSIGNED_BYTE, source);
+  }
+
+  if (RenderStats* stats = RenderStats::Get()) {
+    stats->AddTextureUpload(bytes);
+  }
+  m_Current.nextRow += rows;
+}
+
+void TextureStreamer::FinishUpload() {
+  // No mipmaps: streamed textures are sampled GL_NEAREST, and generating
+  // them would be an unbudgeted full-texture pass
+  m_Current.image.texture->Adopt(m_Current.id, m_Current.image.width, m_Current.image.height);
+  std::cout << "Texture streamed: " << m_Current.image.path << std::endl;
+  FreePixels(m_Current.image);
+  m_Current = {};
+  m_Uploading = false;
+}
+
+bool TextureStreamer::IsBusy() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Uploading || m_Decoding > 0 || !m_Decoded.empty();
+}
+
+size_t TextureStreamer::GetPendingCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return (size_t)m_Decoding + m_Decoded.size() + (m_Uploading ? 1 : 0);
+}
@@ -0,0 +1,107 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <memory>
+
+ThreadPool::ThreadPool(int threadCount) : m_Stopping(false) {
+  if (threadCount <= 0) {
+    threadCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+  }
+  for (int i = 0; i < threadCount; i++) {
+    m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stopping = true;
+  }
+  m_TaskReady.notify_all();
+  for (std::thread& worker : m_Workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Tasks.push_back(std::move(task));
+  }
+  m_TaskReady.notify_one();
+}
+
+void ThreadPool::SubmitBackground(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_BackgroundTasks.push_back(std::move(task));
+  }
+  m_TaskReady.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t chunkCount,
+                             const std::function<void(size_t, size_t, size_t)>& body) {
+  chunkCount = std::min(chunkCount, count);
+  if (chunkCount <= 1) {
+    if (count > 0) {
+      body(0, 0, count);
+    }
+    return;
+  }
+
+  // Chunks are claimed from a shared counter, so whoever is free runs the
+  // next one. Helpers that start after every chunk is claimed return at
+  // once; they only touch the shared state, never body, which lives on
+  // this stack. Chunk boundaries depend only on count and chunkCount, so
+  // results stay deterministic whichever thread runs a chunk.
+  struct Job {
+    std::atomic<size_t> next{0};
+    size_t finished = 0;  // guarded by mutex
+    std::mutex mutex;
+    std::condition_variable done;
+  };
+  auto job = std::make_shared<Job>();
+  const std::function<void(size_t, size_t, size_t)>* run = &body;
+  auto runChunks = [job, run, count, chunkCount]() {
+    size_t ran = 0;
+    for (size_t chunk; (chunk = job->next.fetch_add(1)) < chunkCount; ran++) {
+      (*run)(chunk, count * chunk / chunkCount, count * (chunk + 1) / chunkCount);
+    }
+    if (ran > 0) {
+      std::lock_guard<std::mutex> lock(job->mutex);
+      job->finished += ran;
+      if (job->finished == chunkCount) {
+        job->done.notify_one();
+      }
+    }
+  };
+
+  size_t helpers = std::min(chunkCount - 1, m_Workers.size());
+  for (size_t i = 0; i < helpers; i++) {
+    Submit(runChunks);
+  }
+
+  runChunks();
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->done.wait(lock, [&job, chunkCount]() { return job->finished == chunkCount; });
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_TaskReady.wait(lock, [this]() {
+        return m_Stopping || !m_Tasks.empty() || !m_BackgroundTasks.empty();
+      });
+      // Frame work first; background work only when none is waiting
+      std::deque<std::function<void()>>& queue =
+          !m_Tasks.empty() ? m_Tasks : m_BackgroundTasks;
+      if (queue.empty()) {
+        return;
+      }
+      task = std::move(queue.front());
+      queue.pop_front();
+    }
+    task();
+  }
+}
@@ -0,0 +1,209 @@
+#include "Tilemap.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+Tilemap::Tilemap(int width, int height, float tileSize, glm::vec2 origin)
+    : m_Width(width), m_Height(height), m_TileSize(tileSize), m_Origin(origin),
+      m_ChunkColumns((width + kChunkSize - 1) / kChunkSize),
+      m_ChunkRows((height + kChunkSize - 1) / kChunkSize), m_Tileset(nullptr),
+      m_Shader(nullptr), m_TilesetColumns(0), m_TilesetRows(0), m_EBO(0),
+      m_DrawnChunks(0), m_RebuiltChunks(0) {}
+
+Tilemap::~Tilemap() {
+  Cleanup();
+}
+
+bool Tilemap::Init(Texture* tileset, int tilePixelWidth, int tilePixelHeight, Shader* shader) {
+  if (!tileset || !shader || tilePixelWidth <= 0 || tilePixelHeight <= 0) {
+    std::cerr << "Tilemap needs a tileset, tile size and shader" << std::endl;
+    return false;
+  }
+  m_Tileset = tileset;
+  m_Shader = shader;
+  m_TilesetColumns = tileset->GetWidth() / tilePixelWidth;
+  m_TilesetRows = tileset->GetHeight() / tilePixelHeight;
+
+  // Resolve every cell to its atlas region once instead of per tile
+  m_TileUVs.clear();
+  float cellU = 1.0f / m_TilesetColumns;
+  float cellV = 1.0f / m_TilesetRows;
+  for (int row = 0; row < m_TilesetRows; row++) {
+    for (int column = 0; column < m_TilesetColumns; column++) {
+      m_TileUVs.push_back(tileset->MapUV(glm::vec4(column * cellU, row * cellV, cellU, cellV)));
+    }
+  }
+
+  // Same winding as SpriteBatch quads; a chunk has at most 4096 vertices, so
+  // 16-bit indices are enough
+  std::vector<unsigned short> indices;
+  indices.reserve(kChunkSize * kChunkSize * 6);
+  for (int quad = 0; quad < kChunkSize * kChunkSize; quad++) {
+    unsigned short base = (unsigned short)(quad * 4);
+    unsigned short quadIndices[6] = {0, 1, 3, 1, 2, 3};
+    for (unsigned short index : quadIndices) {
+      indices.push_back(base + index);
+    }
+  }
+  glGenBuffers(1, &m_EBO);
+  GLStateCache* state = GLStateCache::Get();
+  state->BindVertexArray(0);
+  state->BindBuffer(GL_ARRAY_BUFFER, m_EBO);
+  glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.data(),
+               GL_STATIC_DRAW);
+  return true;
+}
+
+void Tilemap::Cleanup() {
+  GLStateCache* state = GLStateCache::Get();
+  for (Layer& layer : m_Layers) {
+    for (Chunk& chunk : layer.chunks) {
+      if (chunk.VAO != 0) {
+        state->DeleteVertexArray(chunk.VAO);
+        state->DeleteBuffer(chunk.VBO);
+      }
+    }
+  }
+  m_Layers.clear();
+  if (m_EBO != 0) {
+    state->DeleteBuffer(m_EBO);
+    m_EBO = 0;
+  }
+}
+
+int Tilemap::AddLayer() {
+  Layer layer;
+  layer.tiles.assign((size_t)m_Width * m_Height, 0);
+  layer.chunks.assign((size_t)m_ChunkColumns * m_ChunkRows, Chunk{0, 0, 0, false});
+  m_Layers.push_back(std::move(layer));
+  return (int)m_Layers.size() - 1;
+}
+
+void Tilemap::SetTile(int layer, int x, int y, uint16_t tile) {
+  if (layer < 0 || layer >= (int)m_Layers.size() || x < 0 || y < 0 ||
+      x >= m_Width || y >= m_Height) {
+    return;
+  }
+  Layer& target = m_Layers[layer];
+  uint16_t& current = target.tiles[(size_t)y * m_Width + x];
+  if (current == tile) {
+    return;
+  }
+  current = tile;
+  target.chunks[(y / kChunkSize) * m_ChunkColumns + x / kChunkSize].dirty = true;
+}
+
+uint16_t Tilemap::GetTile(int layer, int x, int y) const {
+  if (layer < 0 || layer >= (int)m_Layers.size() || x < 0 || y < 0 ||
+      x >= m_Width || y >= m_Height) {
+    return 0;
+  }
+  return m_Layers[layer].tiles[(size_t)y * m_Width + x];
+}
+
+void Tilemap::Draw(const glm::vec4& viewRect) {
+  m_DrawnChunks = 0;
+  m_RebuiltChunks = 0;
+  if (m_Layers.empty() || !m_Shader) {
+    return;
+  }
+
+  // View rect to the range of chunks it touches
+  float chunkWorldSize = kChunkSize * m_TileSize;
+  int minX = std::max(0, (int)std::floor((viewRect.x - m_Origin.x) / chunkWorldSize));
+  int minY = std::max(0, (int)std::floor((viewRect.y - m_Origin.y) / chunkWorldSize));
+  int maxX = std::min(m_ChunkColumns - 1, (int)std::floor((viewRect.z - m_Origin.x) / chunkWorldSize));
+  int maxY = std::min(m_ChunkRows - 1, (int)std::floor((viewRect.w - m_Origin.y) / chunkWorldSize));
+  if (minX > maxX || minY > maxY) {
+    return;
+  }
+
+  GLStateCache* state = GLStateCache::Get();
+  RenderStats* stats = RenderStats::Get();
+  m_Shader->Use();
+  state->BindTexture(m_Tileset->GetID());
+  // Color attribute is disabled in chunk VAOs and reads this constant white
+  glVertexAttrib4f(2, 1.0f, 1.0f, 1.0f, 1.0f);
+
+  for (Layer& layer : m_Layers) {
+    for (int chunkY = minY; chunkY <= maxY; chunkY++) {
+      for (int chunkX = minX; chunkX <= maxX; chunkX++) {
+        Chunk& chunk = layer.chunks[chunkY * m_ChunkColumns + chunkX];
+        if (chunk.dirty) {
+          BuildChunk(layer, chunkX, chunkY);
+        }
+        if (chunk.quadCount == 0) {
+          continue;
+        }
+        state->BindVertexArray(chunk.VAO);
+        glDrawElements(GL_TRIANGLES, chunk.quadCount * 6, GL_UNSIGNED_SHORT, 0);
+        m_DrawnChunks++;
+        stats->AddDrawCall(chunk.quadCount * 2);
+      }
+    }
+  }
+}
+
+void Tilemap::BuildChunk(Layer& layer, int chunkX, int chunkY) {
+  Chunk& chunk = layer.chunks[chunkY * m_ChunkColumns + chunkX];
+  chunk.dirty = false;
+  m_RebuiltChunks++;
+
+  std::vector<TileVertex> vertices;
+  int firstX = chunkX * kChunkSize;
+  int firstY = chunkY * kChunkSize;
+  int lastX = std::min(firstX + kChunkSize, m_Width);
+  int lastY = std::min(firstY + kChunkSize, m_Height);
+  for (int y = firstY; y < lastY; y++) {
+    for (int x = firstX; x < lastX; x++) {
+      uint16_t tile = layer.tiles[(size_t)y * m_Width + x];
+      if (tile == 0 || tile > m_TileUVs.size()) {
+        continue;
+      }
+      const glm::vec4& uv = m_TileUVs[tile - 1];
+      float left = m_Origin.x + x * m_TileSize;
+      float top = m_Origin.y + y * m_TileSize;
+      float right = left + m_TileSize;
+      float bottom = top + m_TileSize;
+      vertices.push_back({glm::vec2(right, bottom), glm::vec2(uv.x + uv.z, uv.y + uv.w)});
+      vertices.push_back({glm::vec2(right, top), glm::vec2(uv.x + uv.z, uv.y)});
+      vertices.push_back({glm::vec2(left, top), glm::vec2(uv.x, uv.y)});
+      vertices.push_back({glm::vec2(left, bottom), glm::vec2(uv.x, uv.y + uv.w)});
+    }
+  }
+
+  chunk.quadCount = (int)vertices.size() / 4;
+  if (chunk.quadCount == 0) {
+    // Keep GL objects of chunks that became empty, they may fill up again
+    return;
+  }
+
+  GLStateCache* state = GLStateCache::Get();
+  if (chunk.VAO == 0) {
+    glGenVertexArrays(1, &chunk.VAO);
+    glGenBuffers(1, &chunk.VBO);
+    state->BindVertexArray(chunk.VAO);
+    state->BindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+    state->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+
+    // Position attribute
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TileVertex),
+                          (void *)offsetof(TileVertex, position));
+    glEnableVertexAttribArray(0);
+
+    // Texture Coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TileVertex),
+                          (void *)offsetof(TileVertex, texCoord));
+    glEnableVertexAttribArray(1);
+  } else {
+    state->BindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+  }
+
+  // Static: written on change only, drawn every frame the chunk is visible
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(TileVertex), vertices.data(),
+               GL_STATIC_DRAW);
+  RenderStats::Get()->AddStreamedBytes(vertices.size() * sizeof(TileVertex));
+}
@@ -1,9 +1,139 @@
 #include "Game.h"
+#include "Animation.h"
+#include "GameObject.h"
+#include "SoftwareRasterizer.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
 Game *game = nullptr;
 
+// Draws a fixed test scene with the software backend and writes it to path.
+// Creates no window or GL context, so it runs on machines without a GPU.
+static bool RenderHeadless(const char* path) {
+  ThreadPool pool;
+  SoftwareRasterizer raster;
+  if (!raster.Init(800, 600, &pool)) {
+    return false;
+  }
+
+  int sheetWidth = 0, sheetHeight = 0;
+  GLuint knightID = raster.LoadTexture("assets/Character/knight.png", &sheetWidth,
+                                       &sheetHeight);
+  if (knightID == 0) {
+    return false;
+  }
+  // Objects resolve textures by handle; the manager touches no GL while it
+  // only holds wrapped textures
+  ResourceManager resources;
+  Texture* knightSheet = new Texture();
+  knightSheet->Wrap(knightID, sheetWidth, sheetHeight);
+  TextureHandle knight = resources.AddTexture("knight", knightSheet);
+  // First frame of the walk cycle
+  Animation standing(knight,
+                     {glm::vec4(0.0f, 0.0f, 16.0f / sheetWidth, 16.0f / sheetHeight)}, 0.0f);
+
+  std::vector<GameObject> objects;
+  GameObject wall(glm::vec2(400.0f, 500.0f), glm::vec2(600.0f, 40.0f), TextureHandle());
+  wall.layer = RenderLayer::Background;
+  wall.color = glm::vec4(0.2f, 0.3f, 0.8f, 1.0f);
+  objects.push_back(wall);
+  GameObject circle(glm::vec2(600.0f, 200.0f), glm::vec2(100.0f, 100.0f), TextureHandle());
+  circle.shape = SpriteShape::Circle;
+  circle.color = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+  objects.push_back(circle);
+  for (int i = 0; i < 64; i++) {
+    GameObject sprite(glm::vec2(100.0f + (i % 8) * 40.0f, 100.0f + (i / 8) * 40.0f),
+                      glm::vec2(32.0f, 32.0f), knight);
+    sprite.currentAnimation = &standing;
+    sprite.color = glm::vec4(1.0f, 1.0f, 1.0f, i % 2 ? 0.5f : 1.0f);
+    objects.push_back(sprite);
+  }
+
+  RenderQueue queue;
+  for (const GameObject& object : objects) {
+    object.Draw(queue, resources);
+  }
+
+  raster.SetView(glm::vec4(0.0f, 0.0f, 800.0f, 600.0f));
+  raster.Clear(glm::vec4(1.0f));
+  raster.Begin();
+  queue.Flush(raster);
+  raster.End();
+  if (!raster.SavePNG(path)) {
+    return false;
+  }
+  std::cout << "Rendered headless frame to " << path << std::endl;
+  return true;
+}
+
 int main(int argc, char *argv[]) {
+  // --bench-sprites <count>: sprite batching benchmark
+  // --bench-tiles <size>: size x size tilemap benchmark
+  // --bench-particles <count>: particle system benchmark
+  // --bench-lights <count>: tiled point light benchmark
+  // --bench-animated <count>: GPU sprite animation benchmark
+  // --bench-streaming <count>: asynchronous texture streaming benchmark
+  // --render-path vertices|instanced: SpriteBatch submission path
+  // --render-stats: print render statistics every second
+  // --stats-csv <path>: write per-frame render statistics as CSV
+  // --debug-draw: start with the collision debug overlay (F1 toggles)
+  // --dynamic-resolution <ms>: scale the world resolution to a frame budget
+  // --no-layer-cache: draw static layers every frame
+  // --capture <target>: record frames as a PNG sequence, a .raw file or
+  //   "|command" piped to an encoder
+  // --pack <path>: cooked asset pack to load from ("" for loose files only)
+  // --no-idle-skip: render every frame even when nothing changed
+  // --headless <path>: render a test scene on the CPU to a PNG and exit
+
+  // Headless runs never touch Game: its cleanup shuts down SDL, the mixer
+  // and SDL_ttf, none of which are initialized here
+  for (int i = 1; i + 1 < argc; i++) {
+    if (std::strcmp(argv[i], "--headless") == 0) {
+      return RenderHeadless(argv[i + 1]) ? 0 : 1;
+    }
+  }
+
   game = new Game();
+  bool printStats = false;
+  std::string statsCSV;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--bench-sprites") == 0 && i + 1 < argc) {
+      game->SetBenchmark(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--bench-tiles") == 0 && i + 1 < argc) {
+      game->SetTileBenchmark(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--bench-particles") == 0 && i + 1 < argc) {
+      game->SetParticleBenchmark(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--bench-lights") == 0 && i + 1 < argc) {
+      game->SetLightBenchmark(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--bench-animated") == 0 && i + 1 < argc) {
+      game->SetAnimationBenchmark(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--bench-streaming") == 0 && i + 1 < argc) {
+      game->SetStreamingBenchmark(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--render-path") == 0 && i + 1 < argc) {
+      i++;
+      game->SetSpriteBatchMode(std::strcmp(argv[i], "vertices") == 0
+                                   ? SpriteBatchMode::Vertices
+                                   : SpriteBatchMode::Instanced);
+    } else if (std::strcmp(argv[i], "--render-stats") == 0) {
+      printStats = true;
+    } else if (std::strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc) {
+      statsCSV = argv[++i];
+    } else if (std::strcmp(argv[i], "--debug-draw") == 0) {
+      game->SetDebugOverlay(true);
+    } else if (std::strcmp(argv[i], "--dynamic-resolution") == 0 && i + 1 < argc) {
+      game->SetDynamicResolution(std::atof(argv[++i]));
+    } else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+      game->SetCapture(argv[++i]);
+    } else if (std::strcmp(argv[i], "--no-layer-cache") == 0) {
+      game->SetLayerCache(false);
+    } else if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+      game->SetAssetPack(argv[++i]);
+    } else if (std::strcmp(argv[i], "--no-idle-skip") == 0) {
+      game->SetIdleSkip(false);
+    }
+  }
+  game->SetRenderStats(printStats, statsCSV);
 
   game->Init("Wayne Engine", 800, 600, false);
 
@@ -12,6 +142,8 @@ int main(int argc, char *argv[]) {
   float deltaTime;
 
   while (game->Running()) {
+    // Sleeps while the screen is idle; the wait counts into deltaTime
+    game->WaitForActivity();
     currentTime = SDL_GetTicks64();
     deltaTime = (currentTime - lastTime) / 1000.0f;
     lastTime = currentTime;
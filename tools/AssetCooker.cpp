@@ -0,0 +1,251 @@
+// Offline asset cooker: converts an assets directory into one AssetPack
+// file (see AssetPack.h), so the game maps it instead of decoding images and
+// audio at startup.
+//
+//   asset_cooker <assets dir> <output pack>
+//
+// Keys are the assets directory as given joined with each file's relative
+// path, so run it from the directory the game runs in:
+//   asset_cooker assets assets.pak
+#define SDL_MAIN_HANDLED
+#include "AssetPack.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// What Game opens the mixer with (Mix_OpenAudio in Game::InitSDL); packs
+// cooked for another format fall back to the loose files at runtime
+constexpr int kMixerFrequency = 44100;
+constexpr SDL_AudioFormat kMixerFormat = AUDIO_S16SYS;
+constexpr int kMixerChannels = 2;
+
+struct CookedAsset {
+  AssetPackEntry entry;
+  std::vector<uint8_t> data;
+};
+
+std::string Lowercase(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(),
+                 [](unsigned char c) { return (char)std::tolower(c); });
+  return text;
+}
+
+// Appends the next mip level of a width x height RGBA8 image, box filtered
+void AppendHalfSize(std::vector<uint8_t>& out, size_t levelOffset, int width, int height) {
+  int halfWidth = std::max(width / 2, 1);
+  int halfHeight = std::max(height / 2, 1);
+  size_t nextOffset = out.size();
+  out.resize(nextOffset + (size_t)halfWidth * halfHeight * 4);
+  const uint8_t* source = out.data() + levelOffset;
+  uint8_t* destination = out.data() + nextOffset;
+  for (int y = 0; y < halfHeight; y++) {
+    int y0 = std::min(y * 2, height - 1);
+    int y1 = std::min(y * 2 + 1, height - 1);
+    for (int x = 0; x < halfWidth; x++) {
+      int x0 = std::min(x * 2, width - 1);
+      int x1 = std::min(x * 2 + 1, width - 1);
+      for (int c = 0; c < 4; c++) {
+        int sum = source[((size_t)y0 * width + x0) * 4 + c] +
+                  source[((size_t)y0 * width + x1) * 4 + c] +
+                  source[((size_t)y1 * width + x0) * 4 + c] +
+                  source[((size_t)y1 * width + x1) * 4 + c];
+        destination[((size_t)y * halfWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+      }
+    }
+  }
+}
+
+bool CookTexture(const fs::path& file, CookedAsset& asset) {
+  int width = 0, height = 0, channels = 0;
+  unsigned char* pixels = stbi_load(file.string().c_str(), &width, &height, &channels, 4);
+  if (!pixels) {
+    std::cerr << "Failed to decode " << file.string() << ": " << stbi_failure_reason()
+              << std::endl;
+    return false;
+  }
+  if (width > (int)kMaxAssetTextureSize || height > (int)kMaxAssetTextureSize) {
+    std::cerr << file.string() << " is larger than " << kMaxAssetTextureSize << " pixels"
+              << std::endl;
+    stbi_image_free(pixels);
+    return false;
+  }
+  asset.data.assign(pixels, pixels + (size_t)width * height * 4);
+  stbi_image_free(pixels);
+
+  int levels = 1;
+  size_t levelOffset = 0;
+  for (int w = width, h = height; w > 1 || h > 1; levels++) {
+    size_t nextOffset = asset.data.size();
+    AppendHalfSize(asset.data, levelOffset, w, h);
+    levelOffset = nextOffset;
+    w = std::max(w / 2, 1);
+    h = std::max(h / 2, 1);
+  }
+
+  asset.entry.type = AssetType::Texture;
+  asset.entry.info[0] = (uint32_t)width;
+  asset.entry.info[1] = (uint32_t)height;
+  asset.entry.info[2] = (uint32_t)levels;
+  return true;
+}
+
+bool CookSound(const fs::path& file, CookedAsset& asset) {
+  SDL_AudioSpec spec;
+  Uint8* samples = nullptr;
+  Uint32 length = 0;
+  if (!SDL_LoadWAV(file.string().c_str(), &spec, &samples, &length)) {
+    std::cerr << "Failed to decode " << file.string() << ": " << SDL_GetError() << std::endl;
+    return false;
+  }
+
+  SDL_AudioCVT convert;
+  if (SDL_BuildAudioCVT(&convert, spec.format, spec.channels, spec.freq, kMixerFormat,
+                        kMixerChannels, kMixerFrequency) < 0) {
+    std::cerr << "Cannot convert " << file.string() << ": " << SDL_GetError() << std::endl;
+    SDL_FreeWAV(samples);
+    return false;
+  }
+  std::vector<uint8_t> buffer((size_t)length * std::max(convert.len_mult, 1));
+  std::memcpy(buffer.data(), samples, length);
+  SDL_FreeWAV(samples);
+  convert.buf = buffer.data();
+  convert.len = (int)length;
+  if (convert.needed && SDL_ConvertAudio(&convert) < 0) {
+    std::cerr << "Cannot convert " << file.string() << ": " << SDL_GetError() << std::endl;
+    return false;
+  }
+  buffer.resize(convert.needed ? (size_t)convert.len_cvt : length);
+  asset.data = std::move(buffer);
+
+  asset.entry.type = AssetType::Sound;
+  asset.entry.info[0] = (uint32_t)kMixerFrequency;
+  asset.entry.info[1] = (uint32_t)kMixerFormat;
+  asset.entry.info[2] = (uint32_t)kMixerChannels;
+  return true;
+}
+
+bool CookBlob(const fs::path& file, CookedAsset& asset) {
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    std::cerr << "Failed to read " << file.string() << std::endl;
+    return false;
+  }
+  asset.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  asset.entry.type = AssetType::Blob;
+  return true;
+}
+
+void Pad(std::ofstream& out, uint64_t& offset) {
+  static const char zeros[kAssetPackAlignment] = {};
+  uint64_t padding = (kAssetPackAlignment - offset % kAssetPackAlignment) % kAssetPackAlignment;
+  out.write(zeros, (std::streamsize)padding);
+  offset += padding;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <assets dir> <output pack>" << std::endl;
+    return 1;
+  }
+  fs::path root = argv[1];
+  if (!fs::is_directory(root)) {
+    std::cerr << "Not a directory: " << root.string() << std::endl;
+    return 1;
+  }
+
+  // Sorted so the same assets always cook to the same pack
+  std::vector<fs::path> files;
+  for (const fs::directory_entry& item : fs::recursive_directory_iterator(root)) {
+    if (item.is_regular_file()) {
+      files.push_back(item.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  std::vector<CookedAsset> assets;
+  for (const fs::path& file : files) {
+    std::string key = (root / fs::relative(file, root)).generic_string();
+    std::string extension = Lowercase(file.extension().string());
+
+    CookedAsset asset{};
+    asset.entry.hash = HashAssetPath(key);
+    bool cooked;
+    if (extension == ".png" || extension == ".jpg" || extension == ".bmp" ||
+        extension == ".tga") {
+      cooked = CookTexture(file, asset);
+    } else if (extension == ".wav") {
+      cooked = CookSound(file, asset);
+    } else {
+      cooked = CookBlob(file, asset);
+    }
+    if (!cooked) {
+      return 1;
+    }
+    asset.entry.size = asset.data.size();
+    // Lets the game notice the file was edited after this cook
+    asset.entry.sourceSize = fs::file_size(file);
+    asset.entry.sourceTime = (int64_t)fs::last_write_time(file).time_since_epoch().count();
+    std::cout << key << " -> " << asset.data.size() << " bytes" << std::endl;
+    assets.push_back(std::move(asset));
+  }
+
+  std::sort(assets.begin(), assets.end(), [](const CookedAsset& a, const CookedAsset& b) {
+    return a.entry.hash < b.entry.hash;
+  });
+  for (size_t i = 1; i < assets.size(); i++) {
+    if (assets[i].entry.hash == assets[i - 1].entry.hash) {
+      std::cerr << "Asset path hash collision; rename one of the files" << std::endl;
+      return 1;
+    }
+  }
+
+  std::ofstream out(argv[2], std::ios::binary);
+  if (!out) {
+    std::cerr << "Failed to open " << argv[2] << std::endl;
+    return 1;
+  }
+  AssetPackHeader header{};
+  std::memcpy(header.magic, kAssetPackMagic, sizeof(header.magic));
+  header.version = kAssetPackVersion;
+  header.entryCount = (uint32_t)assets.size();
+  out.write((const char*)&header, sizeof(header));
+
+  uint64_t offset = sizeof(header);
+  for (CookedAsset& asset : assets) {
+    Pad(out, offset);
+    asset.entry.offset = offset;
+    out.write((const char*)asset.data.data(), (std::streamsize)asset.data.size());
+    offset += asset.data.size();
+  }
+  Pad(out, offset);
+  header.tocOffset = offset;
+  for (const CookedAsset& asset : assets) {
+    out.write((const char*)&asset.entry, sizeof(asset.entry));
+  }
+  out.seekp(0);
+  out.write((const char*)&header, sizeof(header));
+  if (!out) {
+    std::cerr << "Failed to write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::cout << "Cooked " << assets.size() << " assets into " << argv[2] << std::endl;
+  return 0;
+}